@@ -2,6 +2,7 @@
 // Copyright (c) 2020 Pavel Kovalenko
 
 #include "BoardFormat.hpp"
+#include <fstream> // std::ifstream
 
 void BoardFormat::Register(BoardFormatRep const &frep)
 {
@@ -17,3 +18,12 @@ std::unique_ptr<BoardFormat> BoardFormat::Create(char const *tag)
         return nullptr;
     return std::unique_ptr<BoardFormat>(it->second.Factory()());
 }
+
+bool BoardFormat::ReadFile(char const *path)
+{
+    auto fs = std::ifstream(path, std::ios::binary);
+    if (!fs)
+        return false;
+    Read(fs);
+    return true;
+}
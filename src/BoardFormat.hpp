@@ -37,6 +37,8 @@ public:
     virtual char const *Desc() const { return ""; }
     virtual bool CanRead() const { return false; }
     virtual bool CanWrite() const { return false; }
+    // One line per option: "name=values  description"
+    virtual char const *Options() const { return ""; }
     FactoryFunc Factory() const { return factory; }
 };
 
@@ -44,8 +46,12 @@ class BoardFormat
 {
 public:
     virtual ~BoardFormat() = default;    
+    virtual bool SetOption(char const *, char const *) { return false; }
+    virtual bool ReadFile(char const *path);
     virtual void Read(std::istream &) { R_ASSERT(!"Not supported"); }
-    virtual void Export(CBF::Board &) const { R_ASSERT(!"Not supported"); }
+    virtual void Export(CBF::Board &) const & { R_ASSERT(!"Not supported"); }
+    // Consuming export: formats may release their own data while converting it
+    virtual void Export(CBF::Board &cbf) && { static_cast<BoardFormat const &>(*this).Export(cbf); }
     virtual void Import(CBF::Board const &) { R_ASSERT(!"Not supported"); }
     virtual void Write(std::ostream &) const { R_ASSERT(!"Not supported"); }
     virtual BoardFormatRep const &Frep() const = 0;
@@ -10,11 +10,13 @@
 #include "Box2.hpp"
 #include "Edge2.hpp"
 #include "Angle.hpp"
+#include "Matrix23.hpp"
 
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace CBF
 {
@@ -235,6 +237,75 @@ namespace CBF
         {}
     };
 
+    // Copper geometry of a logic layer packed into flat arrays, without
+    // per-primitive objects or allocations. Line and arc widths are looked up
+    // by aperture (D-code) in Widths; surface outlines and cutouts are
+    // contours, i.e. ranges of Vertices.
+    class Geometry
+    {
+    public:
+        struct Line : public Edge2
+        {
+            uint32_t Net;
+            uint32_t Aperture; // index in Widths
+        };
+
+        struct Arc
+        {
+            uint32_t Net;
+            uint32_t Aperture; // index in Widths
+            Vector2 Pos;
+            Scalar Radius;
+            Scalar StartAngle, SweepAngle;
+        };
+
+        struct Surface
+        {
+            uint32_t Net;
+            Scalar LineWidth;
+            // The first contour is the outline, the rest are cutouts
+            uint32_t FirstContour;
+            uint32_t ContourCount;
+        };
+
+        std::vector<Scalar> Widths;
+        std::vector<Line> Lines;
+        std::vector<Arc> Arcs;
+        std::vector<Surface> Surfaces;
+        // Contour i spans Vertices[ContourStart[i], ContourStart[i+1])
+        std::vector<uint32_t> ContourStart = {0};
+        std::vector<Vector2> Vertices;
+
+        Scalar Width(Line const &line) const
+        { return Widths[line.Aperture]; }
+
+        Scalar Width(Arc const &arc) const
+        { return Widths[arc.Aperture]; }
+
+        uint32_t ContourCount() const
+        { return uint32_t(ContourStart.size() - 1); }
+
+        Vector2 const *ContourBegin(uint32_t contour) const
+        { return Vertices.data() + ContourStart[contour]; }
+
+        Vector2 const *ContourEnd(uint32_t contour) const
+        { return Vertices.data() + ContourStart[contour + 1]; }
+
+        void AddSurface(uint32_t net, Scalar lineWidth)
+        { Surfaces.push_back({net, lineWidth, ContourCount(), 0}); }
+
+        // Appends a contour to the last surface, returns its vertices to fill in
+        Vector2 *AddContour(size_t size)
+        {
+            R_ASSERT(!Surfaces.empty());
+            size_t const offset = Vertices.size();
+            Vertices.resize(offset + size);
+            ContourStart.push_back(uint32_t(Vertices.size()));
+            Surfaces.back().ContourCount++;
+            return Vertices.data() + offset;
+        }
+    };
+
     class TestPoint
     {
     public:
@@ -279,9 +350,32 @@ namespace CBF
         std::string Name;
     };
     
+    // Pads shared by all parts with the same footprint, in package coordinates.
+    // Parts placed from a package don't have pads of their own on the layers.
+    class Package
+    {
+    public:
+        struct Pad
+        {
+            std::string Name;
+            // Layer index on an unmirrored part
+            uint32_t Layer;
+            uint32_t Shape;
+            Vector2 Pos; // local pos
+            Angle Turn;
+            Vector2 HoleOffset;
+            Vector2 HoleSize;
+        };
+
+        std::string Name;
+        std::vector<Pad> Pads;
+    };
+
     class Part
     {
     public:
+        static constexpr uint32_t NoPackage = uint32_t(~0);
+
         // Reference designator
         std::string Name;
         // Bounding box that includes pads and package
@@ -298,7 +392,37 @@ namespace CBF
         std::string Desc;
         // Layer index : must be either top or bottom (multilayer and embedded parts are not supported)
         uint32_t Layer;
+        // Pins with pads on the layers; empty for parts placed from a package
         std::vector<Pin> Pins;
+        // Package index, pins are its pads placed with Transform()
+        uint32_t Package = NoPackage;
+        // Placed on the bottom side: the package is flipped and its top and bottom layers swapped
+        bool Mirror = false;
+        // Net of each package pad, ~0 if not connected
+        std::vector<uint32_t> PadNets;
+
+        size_t PinCount() const
+        { return Package == NoPackage ? Pins.size() : PadNets.size(); }
+
+        // Package to board coordinates
+        Matrix23d Transform() const
+        {
+            auto transform = Matrix23d::Translation(Pos);
+            if (Mirror)
+                transform *= Matrix23d::Rotation(-Turn) * Matrix23d::Scaling(Vector2{-1, 1});
+            else
+                transform *= Matrix23d::Rotation(Turn);
+            return transform;
+        }
+    };
+
+    // Pin of a placed part with its pad in board coordinates, see Board::ForEachPin
+    struct PinInstance
+    {
+        uint32_t Layer;
+        uint32_t Id;
+        std::string_view Name;
+        CBF::Pad Pad;
     };
     // Can be an outline or a courtyard
     class Decal
@@ -340,9 +464,7 @@ namespace CBF
     public:
         std::vector<std::unique_ptr<Shape>> Shapes;
         std::vector<Pad> Pads;
-        std::vector<Line> Lines;
-        std::vector<Arc> Arcs;
-        std::vector<Poly> Polys;
+        Geometry Copper;
         std::vector<TestPoint> TestPoints;
 
         LogicLayer() : Layer(LayerClass::Logic)
@@ -372,5 +494,58 @@ namespace CBF
         std::vector<std::string> Nets;
         std::vector<Part> Parts;
         std::vector<Decal> Decals;
+        std::vector<Package> Packages;
+
+        // Calls f(PinInstance const &) for each pin of the part in Id order; pads of
+        // parts placed from a package are transformed on the fly
+        template <typename F>
+        void ForEachPin(Part const &part, F &&f) const
+        {
+            if (part.Package == Part::NoPackage)
+            {
+                for (auto const &pin : part.Pins)
+                {
+                    R_ASSERT(pin.Layer < Layers.size());
+                    LogicLayer const *const layer = *Layers[pin.Layer];
+                    R_ASSERT(layer && pin.Pad < layer->Pads.size());
+                    f(PinInstance{pin.Layer, pin.Id, pin.Name, layer->Pads[pin.Pad]});
+                }
+                return;
+            }
+            R_ASSERT(part.Package < Packages.size());
+            auto const &pkg = Packages[part.Package];
+            R_ASSERT(part.PadNets.size() == pkg.Pads.size());
+            uint32_t const top = FindLayer(LayerType::Top);
+            uint32_t const bottom = FindLayer(LayerType::Bottom);
+            auto const transform = part.Transform();
+            for (uint32_t i = 0; i < pkg.Pads.size(); i++)
+            {
+                auto const &pkgPad = pkg.Pads[i];
+                PinInstance pin{pkgPad.Layer, i + 1, pkgPad.Name, {}};
+                if (part.Mirror)
+                {
+                    if (pin.Layer == top)
+                        pin.Layer = bottom;
+                    else if (pin.Layer == bottom)
+                        pin.Layer = top;
+                }
+                pin.Pad.Net = part.PadNets[i];
+                pin.Pad.Shape = pkgPad.Shape;
+                pin.Pad.Pos = transform * pkgPad.Pos;
+                pin.Pad.Turn = pkgPad.Turn;
+                pin.Pad.HoleOffset = pkgPad.HoleOffset;
+                pin.Pad.HoleSize = pkgPad.HoleSize;
+                f(static_cast<PinInstance const &>(pin));
+            }
+        }
+
+        // Index of the first layer of the given type, Layers.size() if there's none
+        uint32_t FindLayer(LayerType type) const
+        {
+            uint32_t i = 0;
+            while (i < Layers.size() && Layers[i]->Type != type)
+                i++;
+            return i;
+        }
     };
 } // namespace CBF
@@ -4,41 +4,55 @@
 #include "EagleBoard.hpp"
 #include "CBF/Board.hpp"
 #include "BoardFormatRegistrator.hpp"
+#include "FileMapping.hpp"
 #include "Matrix23.hpp"
-#include <streambuf> // istreambuf_iterator
+#include "TaskPool.hpp"
 #include <algorithm>
 #include <array>
+#include <charconv>
 #include <cstdlib>
-#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <utility>
 
 namespace Eagle
 {
-    static double MillimetersToMils(double v) { return 39.3701*v; }
+    // 1 mm is 39.3701 mils, applied to the decimal digits so there's a single rounding
+    static double MillimetersToMils(XML::FixedDecimal v) { return v.Scaled(393701, 4); }
 
-    static Vector2d MetricVec(double x, double y)
+    static Vector2d MetricVec(XML::FixedDecimal x, XML::FixedDecimal y)
     {
         return {MillimetersToMils(x), MillimetersToMils(y)};
     }
 
     Board::LibraryInfo Board::ExtractLibraryInfo(XMLProxy &item)
     {
-        return {item.String("name")};
+        return {std::string(item.String("name")), {}};
     }
 
+    // Each extractor looks up its attributes in one walk, see XML::AttributeSet
+
     Board::PartInfo Board::ExtractPartInfo(XMLProxy &item)
     {
+        struct Attrs { XML::AttributeRef Name, Library, Package, Value, X, Y, Rot; };
+        static constexpr XML::AttributeKey<Attrs> keys[] =
+        {
+            {"name", &Attrs::Name}, {"library", &Attrs::Library}, {"package", &Attrs::Package},
+            {"value", &Attrs::Value}, {"x", &Attrs::X}, {"y", &Attrs::Y}, {"rot", &Attrs::Rot}
+        };
+        auto const attrs = XML::AttributeSet<keys>::Read(item);
         PartInfo info{};
-        info.Name = item.String("name");
-        info.Library = item.String("library");
-        info.Package = item.String("package");
-        info.Value = item.String("value");
-        info.Pos = MetricVec(item.Double("x"), item.Double("y"));
+        info.Name = attrs.Name.String();
+        info.Library = attrs.Library.String();
+        info.Package = attrs.Package.String();
+        info.Value = attrs.Value.String();
+        info.Pos = MetricVec(attrs.X.Decimal(), attrs.Y.Decimal());
         info.Spin = false;
         info.Mirror = false;
         info.Rot = Angle::FromDegrees(0);
-        if (item.HasAttribute("rot"))
+        if (attrs.Rot.Has())
         {
-            std::string const rotStr = item.String("rot");
+            auto const rotStr = attrs.Rot.String();
             for (size_t i = 0; i < rotStr.size(); i++)
             {
                 switch (rotStr[i])
@@ -50,11 +64,10 @@ namespace Eagle
                     info.Mirror = true;
                     break;
                 case 'R':
-                    errno = 0;
-                    double const degrees = std::strtod(rotStr.data()+i+1, nullptr);
-                    if (errno)
+                    XML::FixedDecimal degrees;
+                    if (XML::FixedDecimal::FromChars(rotStr.data()+i+1, rotStr.data()+rotStr.size(), degrees).ec != std::errc())
                         throw std::runtime_error("Can't parse 'rot' attribute: invalid angle");
-                    info.Rot = Angle::FromDegrees(degrees);
+                    info.Rot = Angle::FromDegrees(degrees.ToDouble());
                     i = rotStr.size();
                     break;
                 }
@@ -65,55 +78,73 @@ namespace Eagle
 
     Board::SignalInfo Board::ExtractSignalInfo(XMLProxy &item)
     {
-        return {item.String("name")};
+        return {std::string(item.String("name"))};
     }
 
     Board::ContactRefInfo Board::ExtractContactRef(XMLProxy &item)
     {
+        struct Attrs { XML::AttributeRef Element, Pad; };
+        static constexpr XML::AttributeKey<Attrs> keys[] =
+            {{"element", &Attrs::Element}, {"pad", &Attrs::Pad}};
+        auto const attrs = XML::AttributeSet<keys>::Read(item);
         ContactRefInfo cref{};
-        cref.Element = item.String("element");
-        cref.Pad = item.String("pad");
+        cref.Element = attrs.Element.String();
+        cref.Pad = attrs.Pad.String();
         return cref;
     }
 
     Board::PackageInfo Board::ExtractPackageInfo(XMLProxy &item)
     {
-        return {item.String("name")};
+        return {std::string(item.String("name")), {}};
     }
     
     Board::PadInfo Board::ExtractPadInfo(XMLProxy &item)
     {
+        struct Attrs { XML::AttributeRef Name, X, Y, Drill, Diameter, Dx, Dy, Layer; };
+        static constexpr XML::AttributeKey<Attrs> keys[] =
+        {
+            {"name", &Attrs::Name}, {"x", &Attrs::X}, {"y", &Attrs::Y}, {"drill", &Attrs::Drill},
+            {"diameter", &Attrs::Diameter}, {"dx", &Attrs::Dx}, {"dy", &Attrs::Dy}, {"layer", &Attrs::Layer}
+        };
+        auto const attrs = XML::AttributeSet<keys>::Read(item);
         PadInfo pad{};
-        pad.Name = item.String("name");
-        pad.Pos = MetricVec(item.Double("x"), item.Double("y"));
-        if (item.HasAttribute("drill")) // through-hole pad
+        pad.Name = attrs.Name.String();
+        pad.Pos = MetricVec(attrs.X.Decimal(), attrs.Y.Decimal());
+        if (attrs.Drill.Has()) // through-hole pad
         {
-            double diam;
-            if (item.HasAttribute("diameter"))
-                diam = item.Double("diameter");
+            XML::FixedDecimal diam;
+            if (attrs.Diameter.Has())
+                diam = attrs.Diameter.Decimal();
             else
-                diam = item.Double("drill");
+                diam = attrs.Drill.Decimal();
             pad.Size = MetricVec(diam, diam);
             pad.Layer = LayerId::Multilayer;
         }
         else // smd pad
         {
-            pad.Size = MetricVec(item.Double("dx"), item.Double("dy"));
-            pad.Layer = LayerId(item.Int32("layer"));
+            pad.Size = MetricVec(attrs.Dx.Decimal(), attrs.Dy.Decimal());
+            pad.Layer = LayerId(attrs.Layer.Int32());
         }
         return pad;
     }
 
     Board::SectionInfo Board::ExtractSectionInfo(XMLProxy &item)
     {
+        struct Attrs { XML::AttributeRef X1, Y1, X2, Y2, Width, Layer, Curve; };
+        static constexpr XML::AttributeKey<Attrs> keys[] =
+        {
+            {"x1", &Attrs::X1}, {"y1", &Attrs::Y1}, {"x2", &Attrs::X2}, {"y2", &Attrs::Y2},
+            {"width", &Attrs::Width}, {"layer", &Attrs::Layer}, {"curve", &Attrs::Curve}
+        };
+        auto const attrs = XML::AttributeSet<keys>::Read(item);
         SectionInfo section{};
         section.Edge = {
-            MetricVec(item.Double("x1"), item.Double("y1")),
-            MetricVec(item.Double("x2"), item.Double("y2"))};
-        section.Width = item.Double("width");
-        section.Layer = LayerId(item.Int32("layer"));
-        if (item.HasAttribute("curve"))
-            section.Curve = item.Double("curve");
+            MetricVec(attrs.X1.Decimal(), attrs.Y1.Decimal()),
+            MetricVec(attrs.X2.Decimal(), attrs.Y2.Decimal())};
+        section.Width = attrs.Width.Double();
+        section.Layer = LayerId(attrs.Layer.Int32());
+        if (attrs.Curve.Has())
+            section.Curve = attrs.Curve.Double();
         else
             section.Curve = 0.0;
         return section;
@@ -121,11 +152,15 @@ namespace Eagle
 
     Board::LayerInfo Board::ExtractLayerInfo(XMLProxy &item)
     {
+        struct Attrs { XML::AttributeRef Number, Name, Color, Fill; };
+        static constexpr XML::AttributeKey<Attrs> keys[] =
+            {{"number", &Attrs::Number}, {"name", &Attrs::Name}, {"color", &Attrs::Color}, {"fill", &Attrs::Fill}};
+        auto const attrs = XML::AttributeSet<keys>::Read(item);
         LayerInfo layer{};
-        layer.Number = LayerId(item.Int32("number"));
-        layer.Name = item.String("name");
-        layer.Color = item.Int32("color");
-        layer.Fill = item.Int32("fill");
+        layer.Number = LayerId(attrs.Number.Int32());
+        layer.Name = attrs.Name.String();
+        layer.Color = attrs.Color.Int32();
+        layer.Fill = attrs.Fill.Int32();
         return layer;
     }
 
@@ -177,85 +212,366 @@ namespace Eagle
         }
     }
 
-    void Board::Read(std::istream &fs)
+    // Keeps what the exporter needs as the elements stream past. Each open
+    // element gets a scope from its parent's scope and its name; anything
+    // outside the paths below is Other, and so is everything inside it.
+    // The document pass leaves the libraries and the signal list for later:
+    // they're read as fragments starting in their own scope, one task for the
+    // signals and one per library.
+    class Board::Loader final : public XML::Handler
     {
+    public:
+        enum class Scope
+        {
+            Document,
+            Other,
+            Eagle,
+            Drawing,
+            Layers,
+            Board,
+            Plain,
+            Libraries,
+            Library,
+            Packages,
+            Package,
+            Elements,
+            Signals,
+            Signal,
+        };
+
+        struct Fragment
+        {
+            LibraryInfo Library; // name only
+            std::string_view Content;
+        };
+
+        // document: content of <libraries> and <signals>
+        std::string_view LibraryList;
+        std::string_view SignalList;
+        // library list: the libraries in it
+        std::vector<Fragment> Libraries;
+        // library: what's read
+        LibraryInfo Lib;
+        // signal list: contact refs, with pad names kept by the task
+        struct Binding
+        {
+            uint32_t Element;
+            uint32_t Pad;
+            uint32_t Signal;
+        };
+        NameTable PadNames;
+        std::vector<Binding> Bindings;
+
+    private:
+        Board &board;
+        Scope root;
+        std::vector<Scope> scopes;
+        PackageInfo pkg;
+        uint32_t signalIndex = 0;
+        bool boardFound = false;
+
+        Scope Enter(XML::Element const &item);
+
+        bool Deferred(Scope scope) const
+        {
+            if (root == Scope::Document)
+                return scope == Scope::Libraries || scope == Scope::Signals;
+            return root == Scope::Libraries && scope == Scope::Library;
+        }
+
+    public:
+        Loader(Board &b, Scope rootScope = Scope::Document) :
+            board(b),
+            root(rootScope)
+        {}
+
+        virtual bool StartElement(XML::Element const &item) override
+        {
+            // settings, design rules, descriptions, polygons and the like
+            // aren't read, and neither is anything inside them
+            auto const scope = Enter(item);
+            scopes.push_back(scope);
+            return scope != Scope::Other && !Deferred(scope);
+        }
+
+        virtual void SkippedContent(std::string_view content) override
         {
-            fs.seekg(0, std::ios::end);
-            std::string buf;
-            buf.reserve(size_t(fs.tellg()));
-            fs.seekg(0, std::ios::beg);
-            buf.assign(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
-            const std::string xmlPrefix = "<?xml";
-            if (buf.compare(0, xmlPrefix.size(), xmlPrefix))
+            switch (scopes.back())
             {
-                R_ASSERT(!"Binary Eagle BRD format is not supported. Resave with a newer version and try again.");
+            case Scope::Libraries:
+                LibraryList = content;
+                break;
+            case Scope::Library:
+                Libraries.push_back({std::move(Lib), content});
+                break;
+            case Scope::Signals:
+                SignalList = content;
+                break;
+            default:
+                break;
             }
-            if (src.Parse(buf.c_str()) != tinyxml2::XML_SUCCESS)
+        }
+
+        virtual void EndElement(std::string_view name) override;
+
+        void Finish() const
+        {
+            if (!boardFound)
+                throw XML::Error("Child node not found: board");
+        }
+    };
+
+    Board::Loader::Scope Board::Loader::Enter(XML::Element const &item)
+    {
+        auto const &name = item.Name;
+        switch (scopes.empty() ? root : scopes.back())
+        {
+        case Scope::Document:
+            if (name != "eagle")
+                throw XML::Error("Child node not found: eagle");
+            board.version = item.String("version");
+            return Scope::Eagle;
+        case Scope::Eagle:
+            if (name == "drawing")
+                return Scope::Drawing;
+            break;
+        case Scope::Drawing:
+            if (name == "layers")
+                return Scope::Layers;
+            if (name == "board")
+            {
+                boardFound = true;
+                return Scope::Board;
+            }
+            break;
+        case Scope::Layers:
+            if (name == "layer")
+            {
+                auto layerInfo = ExtractLayerInfo(item);
+                R_ASSERT(board.layers.find(layerInfo.Number) == board.layers.end());
+                board.layers.emplace(layerInfo.Number, std::move(layerInfo));
+            }
+            break;
+        case Scope::Board:
+            if (name == "plain")
+                return Scope::Plain;
+            if (name == "libraries")
+                return Scope::Libraries;
+            if (name == "elements")
+                return Scope::Elements;
+            if (name == "signals")
+                return Scope::Signals;
+            break;
+        case Scope::Plain:
+            if (name == "wire")
+                board.ProcessSection(ExtractSectionInfo(item));
+            break;
+        case Scope::Libraries:
+            if (name == "library")
+            {
+                Lib = ExtractLibraryInfo(item);
+                return Scope::Library;
+            }
+            break;
+        case Scope::Library:
+            if (name == "packages")
+                return Scope::Packages;
+            break;
+        case Scope::Packages:
+            if (name == "package")
+            {
+                pkg = ExtractPackageInfo(item);
+                return Scope::Package;
+            }
+            break;
+        case Scope::Package:
+            if (name == "pad" || name == "smd")
+            {
+                pkg.Pads.push_back(ExtractPadInfo(item));
+            }
+            break;
+        case Scope::Elements:
+            if (name == "element")
+                board.partInfos.push_back(ExtractPartInfo(item));
+            break;
+        case Scope::Signals:
+            if (name == "signal")
+            {
+                auto signalInfo = ExtractSignalInfo(item);
+                signalIndex = uint32_t(board.signals.size());
+                board.netNameToIndex[signalInfo.Name] = signalIndex;
+                board.signals.push_back(std::move(signalInfo));
+                return Scope::Signal;
+            }
+            break;
+        case Scope::Signal:
+            if (name == "contactref")
+            {
+                board.crefCount++;
+                auto const crefInfo = ExtractContactRef(item);
+                // the elements are known by now, and are only looked up here
+                uint32_t const element = board.elementNames.Find(crefInfo.Element);
+                if (element != NameTable::None)
+                    Bindings.push_back({element, PadNames.Intern(crefInfo.Pad), signalIndex});
+            }
+            break;
+        default:
+            break;
+        }
+        return Scope::Other;
+    }
+
+    void Board::Loader::EndElement(std::string_view)
+    {
+        switch (scopes.back())
+        {
+        case Scope::Package:
+        {
+            // sorted by name; of pads with the same name, the last one is kept
+            auto &pads = pkg.Pads;
+            PadComparer const less;
+            std::stable_sort(pads.begin(), pads.end(),
+                [&](PadInfo const &a, PadInfo const &b) { return less(a.Name, b.Name); });
+            size_t count = 0;
+            for (size_t i = 0; i < pads.size(); i++)
             {
-                printf("! %s\n", src.ErrorStr());
-                R_ASSERT(!"XXX: throw an exception here");
+                if (i + 1 < pads.size() && !less(pads[i].Name, pads[i + 1].Name))
+                    continue;
+                if (count != i)
+                    pads[count] = std::move(pads[i]);
+                count++;
             }
+            pads.erase(pads.begin() + count, pads.end());
+            Lib.Packages.push_back(std::move(pkg));
+            break;
         }
-        tinyxml2::XMLBrowser browser(src);
-        version = browser("eagle").String("version");
-        auto drawing = browser("eagle")("drawing");
-        auto brdLayers = drawing("layers");
-        for (auto layer = brdLayers.Begin("layer"); layer; layer.Next("layer"))
-        {
-            auto layerInfo = ExtractLayerInfo(layer);
-            R_ASSERT(layers.find(layerInfo.Number) == layers.end());
-            layers.emplace(layerInfo.Number, std::move(layerInfo));
+        default:
+            break;
+        }
+        scopes.pop_back();
+    }
+
+    bool Board::ReadFile(char const *path)
+    {
+        // the reader works on the mapped file, so only what's extracted from
+        // it takes memory
+        FileMapping file;
+        if (!file.Open(path))
+            return false;
+        Read(reinterpret_cast<char const *>(file.Data()), file.Size());
+        return true;
+    }
+
+    void Board::Read(std::istream &fs)
+    {
+        fs.seekg(0, std::ios::end);
+        std::string buf;
+        buf.resize(size_t(fs.tellg()));
+        fs.seekg(0, std::ios::beg);
+        fs.read(buf.data(), buf.size());
+        buf.resize(size_t(fs.gcount()));
+        Read(buf.data(), buf.size());
+    }
+
+    void Board::Read(char const *data, size_t size)
+    {
+        std::string_view const buf(data, size);
+        const std::string_view xmlPrefix = "<?xml";
+        if (buf.compare(0, xmlPrefix.size(), xmlPrefix))
+        {
+            R_ASSERT(!"Binary Eagle BRD format is not supported. Resave with a newer version and try again.");
         }
-        auto board = drawing("board");
-        for (auto wire = board("plain").Begin("wire"); wire; wire.Next("wire"))
-        {
-            auto sectionInfo = ExtractSectionInfo(wire);
-            ProcessSection(std::move(sectionInfo));
-            //if (!sectionInfo.Curve)
-            //{
-            //    outlineBuilder.AddEdge(sectionInfo.Edge);
-            //    continue;
-            //}
-            //CreatePolyArc(sectionInfo.Edge, sectionInfo.Curve,
-            //    [&](Edge2 e) { outlineBuilder.AddEdge(e); });
+        Loader loader(*this);
+        XML::Reader(data, size).Read(loader);
+        loader.Finish();
+        // the signal list only looks elements up
+        elementNames.Reserve(partInfos.size());
+        for (auto &part : partInfos)
+            part.Element = elementNames.Intern(part.Name);
+        using Scope = Loader::Scope;
+        auto const readFragment = [data](std::string_view content, Loader &fragmentLoader)
+        { XML::Reader(content.data(), content.size(), data).ReadContent(fragmentLoader); };
+        Loader libraryList(*this, Scope::Libraries);
+        readFragment(loader.LibraryList, libraryList);
+        auto &fragments = libraryList.Libraries;
+        uint32_t const jobs = uint32_t(std::min<size_t>(TaskPool::ResolveJobs(Jobs), fragments.size() + 1));
+        if (jobs > 1)
+            printf("- loading %zu libraries with %u jobs\n", fragments.size(), jobs);
+        TaskPool pool(jobs);
+        // signals don't depend on libraries
+        Loader signalList(*this, Scope::Signals);
+        pool.Run([&]() { readFragment(loader.SignalList, signalList); });
+        for (auto &fragment : fragments)
+        {
+            pool.Run([&]()
+            {
+                Loader library(*this, Scope::Library);
+                library.Lib = std::move(fragment.Library);
+                readFragment(fragment.Content, library);
+                fragment.Library = std::move(library.Lib);
+            });
         }
-        for (auto lib = board("libraries").Begin("library"); lib; lib.Next())
+        pool.Wait();
+        // parts find their packages by interned library and package names
+        NameTable libraryNames, packageNames;
+        std::unordered_map<uint64_t, uint32_t> packageIndices;
+        for (auto &fragment : fragments)
         {
-            auto libInfo = ExtractLibraryInfo(lib);
-            for (auto pkg = lib("packages").Begin("package"); pkg; pkg.Next())
+            uint64_t const libId = libraryNames.Intern(fragment.Library.Name);
+            for (auto &pkg : fragment.Library.Packages)
             {
-                auto pkgInfo = ExtractPackageInfo(pkg);
-                for (auto pad = pkg.Begin("pad"); pad; pad.Next("pad"))
-                {
-                    auto padInfo = ExtractPadInfo(pad);
-                    pkgInfo.Pads[padInfo.Name] = std::move(padInfo);
-                }
-                for (auto pad = pkg.Begin("smd"); pad; pad.Next("smd"))
-                {
-                    auto padInfo = ExtractPadInfo(pad);
-                    pkgInfo.Pads[padInfo.Name] = std::move(padInfo);
-                }
-                libInfo.Packages[pkgInfo.Name] = std::move(pkgInfo);
+                // in document order, so that a later package of the same name wins
+                packageIndices[libId << 32 | packageNames.Intern(pkg.Name)] = uint32_t(packages.size());
+                packages.push_back(std::move(pkg));
             }
-            libs[libInfo.Name] = std::move(libInfo);
         }
-        for (auto part = board("elements").Begin("element"); part; part.Next())
-            partInfos.push_back(ExtractPartInfo(part));
-        for (auto signal = board("signals").Begin("signal"); signal; signal.Next())
-        {
-            auto signalInfo = ExtractSignalInfo(signal);
-            uint32_t signalIndex = uint32_t(signals.size());
-            netNameToIndex[signalInfo.Name] = signalIndex;
-            signals.push_back(std::move(signalInfo));
-            for (auto cref = signal.Begin("contactref"); cref; cref.Next("contactref"))
+        size_t padCount = 0;
+        for (auto &part : partInfos)
+        {
+            uint64_t const libId = libraryNames.Find(part.Library);
+            uint32_t const pkgId = packageNames.Find(part.Package);
+            auto const it = libId == NameTable::None || pkgId == NameTable::None ?
+                packageIndices.end() : packageIndices.find(libId << 32 | pkgId);
+            if (it == packageIndices.end())
+                throw std::runtime_error("Package not found: " + part.Library + "/" + part.Package);
+            part.PackageIndex = it->second;
+            part.PadNets = uint32_t(padCount);
+            padCount += packages[part.PackageIndex].Pads.size();
+        }
+        // contact refs are resolved to pads of parts here, so that the export
+        // only copies the nets; parts of the same name share them
+        std::vector<uint32_t> firstPart(elementNames.Size(), NameTable::None);
+        std::vector<uint32_t> nextPart(partInfos.size());
+        for (uint32_t i = uint32_t(partInfos.size()); i-- > 0;)
+            nextPart[i] = std::exchange(firstPart[partInfos[i].Element], i);
+        padNets.assign(padCount, uint32_t(~0));
+        PadComparer const less;
+        for (auto const &binding : signalList.Bindings)
+        {
+            auto const padName = signalList.PadNames[binding.Pad];
+            for (uint32_t i = firstPart[binding.Element]; i != NameTable::None; i = nextPart[i])
             {
-                crefCount++;
-                auto const crefInfo = ExtractContactRef(cref);
-                partSignals[crefInfo.Element][crefInfo.Pad] = signalIndex;
+                auto const &part = partInfos[i];
+                auto const &pads = packages[part.PackageIndex].Pads;
+                auto const pad = std::lower_bound(pads.begin(), pads.end(), padName,
+                    [&](PadInfo const &a, std::string_view b) { return less(a.Name, b); });
+                if (pad != pads.end() && pad->Name == padName)
+                    padNets[part.PadNets + (pad - pads.begin())] = binding.Signal;
             }
         }
     }
 
+    bool Board::SetOption(char const *name, char const *value)
+    {
+        if (!std::strcmp(name, "jobs"))
+        {
+            char *end;
+            Jobs = uint32_t(std::strtoul(value, &end, 10));
+            return *value && !*end;
+        }
+        return false;
+    }
+
     static Board::LayerId operator++(Board::LayerId &id, int)
     {
         auto const r = id;
@@ -324,30 +640,7 @@ namespace Eagle
         layer->Shapes.push_back(std::unique_ptr<CBF::Shape>(shape));
     }
 
-    struct PkgInfo
-    {
-        Box2d Bbox;
-        uint32_t Decal; // index of Decal in Board::Decals
-    };
-
-    struct FullPkgName
-    {
-        std::string_view Lib;
-        std::string_view Pkg;
-
-        bool operator==(FullPkgName const& v) const { return v.Lib==Lib && v.Pkg==Pkg; }
-
-        struct Hash
-        {
-            size_t operator()(FullPkgName const& v) const
-            {
-                std::hash<std::string_view> const hash;
-                return hash(v.Lib) * hash(v.Pkg);
-            }
-        };
-    };
-
-    void Board::Export(CBF::Board &cbf) const
+    void Board::Export(CBF::Board &cbf) const &
     {
         // *** nets
         cbf.Nets.reserve(signals.size());
@@ -398,23 +691,6 @@ namespace Eagle
             }
             cbf.Layers.push_back(std::unique_ptr<CBF::Layer>(layer));
         }
-        // *** decals
-        std::unordered_map<FullPkgName, PkgInfo, FullPkgName::Hash> tempPkgInfos;
-        for (auto const &[libName, lib] : libs)
-        {
-            for (auto const &[pkgName, pkg] : lib.Packages)
-            {
-                auto bbox = Box2d::Empty;
-                for (auto const &[padName, pad] : pkg.Pads)
-                    bbox.Merge(Box2d(pad.Size) + pad.Pos);
-                tempPkgInfos[{libName, pkgName}] = PkgInfo{bbox, uint32_t(cbf.Decals.size())};
-                CBF::Decal decal;
-                decal.Name = pkgName;
-                decal.Outline = {bbox.Min, bbox.Min+bbox.Height(), bbox.Max, bbox.Max-bbox.Height()};
-                cbf.Decals.push_back(std::move(decal));
-            }
-        }
-        // *** parts
         uint32_t const topLayer = FindLayer(cbf, CBF::LayerType::Top);
         uint32_t const bottomLayer = FindLayer(cbf, CBF::LayerType::Bottom);
         uint32_t const multiLayer = FindLayer(cbf, CBF::LayerType::Multilayer);
@@ -433,62 +709,66 @@ namespace Eagle
                 return 0;
             }
         };
+        // *** decals and packages
+        // decal and package indices are those of Board::packages
+        std::vector<Box2d> bboxes;
+        bboxes.reserve(packages.size());
+        cbf.Decals.reserve(packages.size());
+        cbf.Packages.reserve(packages.size());
+        for (auto const &pkg : packages)
+        {
+            auto bbox = Box2d::Empty;
+            for (auto const &pad : pkg.Pads)
+                bbox.Merge(Box2d(pad.Size) + pad.Pos);
+            bboxes.push_back(bbox);
+            CBF::Decal decal;
+            decal.Name = pkg.Name;
+            decal.Outline = {bbox.Min, bbox.Min+bbox.Height(), bbox.Max, bbox.Max-bbox.Height()};
+            cbf.Decals.push_back(std::move(decal));
+            // pads are stored once per package and placed by the parts
+            CBF::Package cbfPkg;
+            cbfPkg.Name = pkg.Name;
+            cbfPkg.Pads.reserve(pkg.Pads.size());
+            for (auto const &pad : pkg.Pads)
+            {
+                CBF::Package::Pad cbfPad;
+                cbfPad.Name = pad.Name;
+                cbfPad.Layer = translateLayer(pad.Layer, false);
+                cbfPad.Shape = 0; // XXX: support shapes
+                cbfPad.Pos = pad.Pos;
+                cbfPad.Turn = Angle::FromDegrees(0); // XXX: support pad rotation
+                cbfPad.HoleOffset = Vector2d::Origin; // XXX: support pad holes
+                cbfPad.HoleSize = Vector2d::Origin;
+                cbfPkg.Pads.push_back(std::move(cbfPad));
+            }
+            cbf.Packages.push_back(std::move(cbfPkg));
+        }
+        // *** parts
         // add dummy shapes to get around without assigning a real shape to each pad
         AddDummyShape(cbf, multiLayer);
         AddDummyShape(cbf, topLayer);
         AddDummyShape(cbf, bottomLayer);
+        cbf.Parts.reserve(partInfos.size());
         for (auto const &part : partInfos)
         {
-            auto const &pkg = libs.at(part.Library).Packages.at(part.Package);
-            auto const &tempPkgInfo = tempPkgInfos.at({part.Library, part.Package});
+            auto const &pkg = packages[part.PackageIndex];
             CBF::Part cbfPart;
             {
                 cbfPart.Name = part.Name;
-                cbfPart.Bbox = tempPkgInfo.Bbox;
+                cbfPart.Bbox = bboxes[part.PackageIndex];
                 cbfPart.Pos = part.Pos;
                 cbfPart.Turn = part.Rot; // top:ccw
-                cbfPart.Decal = tempPkgInfo.Decal;
+                cbfPart.Decal = part.PackageIndex;
                 cbfPart.Height = 0;
                 cbfPart.Value = part.Value;
                 cbfPart.Desc = part.Package;
                 cbfPart.Layer = translateLayer(LayerId::Top, part.Mirror);
-                cbfPart.Pins.reserve(pkg.Pads.size());
-            }
-            auto transform = Matrix23d::Translation(part.Pos);
-            if (part.Mirror)
-                transform *= Matrix23d::Rotation(-part.Rot) * Matrix23d::Scaling(Vector2d{-1, 1});
-            else
-                transform *= Matrix23d::Rotation(part.Rot);
-            // for each pad from eagle package:
-            // - create a pin and append it to cbf part pins
-            // - create a pad and append it to cbf layer
-            uint32_t id = 1;
-            for (auto const &[padName, pad] : pkg.Pads)
-            {
-                CBF::Pin cbfPin;
-                uint32_t const layerIndex = translateLayer(pad.Layer, part.Mirror);
-                cbfPin.Layer = layerIndex;
-                CBF::LogicLayer *const layer = *cbf.Layers[layerIndex];
-                CBF::Pad cbfPad;
-                {
-                    auto const &padNets = partSignals.at(part.Name);
-                    if (const auto padNet = padNets.find(padName); padNet != padNets.end())
-                    {
-                        cbfPad.Net = padNet->second;
-                    }
-                    cbfPad.Shape = 0; // XXX: support shapes
-                    cbfPad.Pos = transform * pad.Pos;
-                    cbfPad.Turn = Angle::FromDegrees(0); // XXX: support pad rotation
-                    cbfPad.HoleOffset = Vector2d::Origin; // XXX: support pad holes
-                    cbfPad.HoleSize = Vector2d::Origin;
-                }
-                layer->Pads.push_back(std::move(cbfPad));
-                cbfPin.Pad = uint32_t(layer->Pads.size())-1;
-                cbfPin.Id = id;
-                cbfPin.Name = pad.Name;
-                cbfPart.Pins.push_back(std::move(cbfPin));
-                id++;
+                cbfPart.Package = part.PackageIndex;
+                cbfPart.Mirror = part.Mirror;
             }
+            // only the nets are per part, pads come from the package
+            auto const nets = padNets.begin() + part.PadNets;
+            cbfPart.PadNets.assign(nets, nets + pkg.Pads.size());
             cbf.Parts.push_back(std::move(cbfPart));
         }
     }
@@ -5,11 +5,13 @@
 
 #include "CBF/Board.hpp"
 #include "BoardFormat.hpp"
-#include "XMLBrowser.hpp"
+#include "XMLReader.hpp"
 #include "Edge2.hpp"
 #include "Matrix23.hpp"
-#include <map>
+#include "NameTable.hpp"
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace Eagle
 {
@@ -27,6 +29,9 @@ namespace Eagle
             bool Mirror;
             bool Spin;
             //char const *CRot; // [Mirror][R][45 degrees] -- example : MR45
+            uint32_t Element; // interned name
+            uint32_t PackageIndex; // into packages
+            uint32_t PadNets; // into padNets, one per package pad
         };
 
         enum class LayerId : int32_t
@@ -53,7 +58,7 @@ namespace Eagle
 
         struct PadComparer
         {
-            bool operator()(std::string const &a, std::string const &b) const
+            bool operator()(std::string_view a, std::string_view b) const
             {
                 if (a.size() < b.size())
                     return true;
@@ -73,21 +78,21 @@ namespace Eagle
         struct PackageInfo
         {
             std::string Name;
-            using PadName = std::string;
-            std::map<PadName, PadInfo, PadComparer> Pads;
+            // sorted by name with PadComparer, names are unique
+            std::vector<PadInfo> Pads;
         };
 
         struct LibraryInfo
         {
             std::string Name;
-            using PackageName = std::string;
-            std::unordered_map<PackageName, PackageInfo> Packages;
+            // in document order
+            std::vector<PackageInfo> Packages;
         };
 
         struct ContactRefInfo
         {
-            char const *Element;
-            char const *Pad;
+            std::string_view Element;
+            std::string_view Pad;
         };
 
         struct SectionInfo
@@ -112,23 +117,24 @@ namespace Eagle
         };
 
     private:
-        tinyxml2::XMLDocument src;
+        class Loader;
+
         std::string version;
         std::unordered_map<LayerId, LayerInfo> layers;
         std::vector<SectionInfo> outline;
         std::vector<PartInfo> partInfos;
-        std::unordered_map<std::string, LibraryInfo> libs;
+        // packages of all libraries, in document order
+        std::vector<PackageInfo> packages;
         std::vector<SignalInfo> signals;
         size_t crefCount = 0;
-        using PadName = std::string;
+        NameTable elementNames;
+        // signal index per pad of each part, ~0 : not connected
+        std::vector<uint32_t> padNets;
         using SignalName = std::string;
-        using SignalMap = std::map<PadName, uint32_t>;
-        using ElementName = std::string;
-        std::unordered_map<ElementName, SignalMap> partSignals;
         std::unordered_map<SignalName, size_t> netNameToIndex;
 
     public:
-        using XMLProxy = tinyxml2::XMLBrowser::Proxy;
+        using XMLProxy = XML::Element const;
 
         static LibraryInfo ExtractLibraryInfo(XMLProxy &item);
         static PartInfo ExtractPartInfo(XMLProxy &item);
@@ -147,10 +153,21 @@ namespace Eagle
             virtual char const *Tag() const override { return "eagle"; }
             virtual char const *Desc() const override { return "Autodesk EAGLE board (*.BRD)"; }
             virtual bool CanRead() const override { return true; }
+            virtual char const *Options() const override
+            {
+                return "jobs=N  library and signal reading threads, 0 for one per core (default: 0)";
+            }
         };
 
+        // Library and signal reading threads, 0 : one per hardware thread
+        uint32_t Jobs = 0;
+
+        virtual bool SetOption(char const *name, char const *value) override;
+        virtual bool ReadFile(char const *path) override;
         virtual void Read(std::istream &fs) override;
-        virtual void Export(CBF::Board &cbf) const override;
+        // Reads a whole file in memory in a single pass, without building a tree
+        void Read(char const *data, size_t size);
+        virtual void Export(CBF::Board &cbf) const & override;
         virtual BoardFormatRep const &Frep() const override;
 
     private:
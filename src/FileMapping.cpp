@@ -0,0 +1,100 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#include "FileMapping.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+#endif
+
+#if defined(_WIN32)
+bool FileMapping::Open(char const *path)
+{
+    Close();
+    HANDLE const f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE)
+        return false;
+    file = f;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(f, &fileSize))
+    {
+        Close();
+        return false;
+    }
+    size = size_t(fileSize.QuadPart);
+    if (!size) // empty files can't be mapped
+        return true;
+    mapping = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        Close();
+        return false;
+    }
+    data = static_cast<uint8_t const *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void FileMapping::Close()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    if (file)
+        CloseHandle(file);
+    data = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    size = 0;
+}
+#else
+bool FileMapping::Open(char const *path)
+{
+    Close();
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        Close();
+        return false;
+    }
+    size = size_t(st.st_size);
+    if (!size) // empty files can't be mapped
+        return true;
+    void *const view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+    madvise(view, size, MADV_SEQUENTIAL);
+    data = static_cast<uint8_t const *>(view);
+    return true;
+}
+
+void FileMapping::Close()
+{
+    if (data)
+        munmap(const_cast<uint8_t *>(data), size);
+    if (fd >= 0)
+        close(fd);
+    data = nullptr;
+    fd = -1;
+    size = 0;
+}
+#endif
@@ -0,0 +1,33 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include <cstddef> // size_t
+
+// Read-only view of a whole file mapped into memory.
+class FileMapping final
+{
+private:
+    uint8_t const *data = nullptr;
+    size_t size = 0;
+#if defined(_WIN32)
+    void *file = nullptr;
+    void *mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+public:
+    FileMapping() = default;
+    FileMapping(FileMapping const &) = delete;
+    FileMapping &operator=(FileMapping const &) = delete;
+    ~FileMapping() { Close(); }
+
+    bool Open(char const *path);
+    void Close();
+
+    uint8_t const *Data() const { return data; }
+    size_t Size() const { return size; }
+};
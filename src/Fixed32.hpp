@@ -69,4 +69,7 @@ namespace Tebo
         bool operator!=(Vector2S rhs) const
         { return X != rhs.X || Y != rhs.Y; }
     };
+
+    // Vector2S arrays are copied straight from packed little-endian int32 pairs
+    static_assert(sizeof(Vector2S) == 2*sizeof(int32_t));
 } // namespace Tebo
@@ -0,0 +1,45 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include <cstddef> // size_t
+#include <cstring> // std::memcpy
+
+// MurmurHash64A: fast non-cryptographic 64-bit hash, used to tell whether
+// a file changed since data derived from it was cached.
+inline uint64_t Hash64(void const *data, size_t size, uint64_t seed = 0)
+{
+    uint64_t const m = 0xc6a4a7935bd1e995ull;
+    int const r = 47;
+    uint64_t h = seed ^ (size * m);
+    auto p = static_cast<uint8_t const *>(data);
+    auto const end = p + (size & ~size_t(7));
+    for (; p != end; p += 8)
+    {
+        uint64_t k;
+        std::memcpy(&k, p, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+    switch (size & 7)
+    {
+    case 7: h ^= uint64_t(p[6]) << 48; [[fallthrough]];
+    case 6: h ^= uint64_t(p[5]) << 40; [[fallthrough]];
+    case 5: h ^= uint64_t(p[4]) << 32; [[fallthrough]];
+    case 4: h ^= uint64_t(p[3]) << 24; [[fallthrough]];
+    case 3: h ^= uint64_t(p[2]) << 16; [[fallthrough]];
+    case 2: h ^= uint64_t(p[1]) << 8; [[fallthrough]];
+    case 1:
+        h ^= uint64_t(p[0]);
+        h *= m;
+    }
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
@@ -97,6 +97,25 @@ struct Matrix23T
 
     static Matrix23T Rotation(Angle angle)
     {
+        // quarter turns are exact and don't need sin and cos: std::cos(Pi/2)
+        // isn't zero, which would skew parts at 90 and 270 degrees. Angles are
+        // only as precise as Angle::Scalar, so they're matched within that.
+        double const quarters = angle.Radians()/(Pi/2);
+        double const nearest = std::round(quarters);
+        double const eps = std::numeric_limits<Angle::Scalar>::epsilon();
+        if (std::abs(quarters - nearest) <= 4*eps*std::abs(nearest))
+        {
+            static constexpr Scalar sins[] = {0, 1, 0, -1};
+            // modulo 4 before the conversion, which would overflow for huge angles
+            int const quarter = int(nearest - 4*std::floor(nearest/4));
+            Scalar const sin = sins[quarter];
+            Scalar const cos = sins[(quarter + 1) & 3];
+            return
+            {
+                cos, -sin, 0,
+                sin, +cos, 0
+            };
+        }
         Scalar const sin = std::sin(angle.Radians());
         Scalar const cos = std::cos(angle.Radians());
         return
@@ -0,0 +1,50 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include "StringPool.hpp"
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Interned names: equal names get the same id, ids are dense and start at 0.
+// Names are copied into the table, so the views passed in may be transient.
+class NameTable final
+{
+private:
+    StringPool pool;
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> names;
+
+public:
+    static constexpr uint32_t None = uint32_t(~0);
+
+    uint32_t Intern(std::string_view name)
+    {
+        if (auto const it = ids.find(name); it != ids.end())
+            return it->second;
+        uint32_t const id = uint32_t(names.size());
+        auto const stored = pool.Store(name.data(), name.size());
+        ids.emplace(stored, id);
+        names.push_back(stored);
+        return id;
+    }
+
+    void Reserve(size_t count)
+    {
+        ids.reserve(count);
+        names.reserve(count);
+    }
+
+    // Returns None for names that weren't interned
+    uint32_t Find(std::string_view name) const
+    {
+        auto const it = ids.find(name);
+        return it == ids.end() ? None : it->second;
+    }
+
+    std::string_view operator[](uint32_t id) const { return names[id]; }
+    size_t Size() const { return names.size(); }
+};
@@ -0,0 +1,201 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include "StreamReader.hpp"
+#include "StreamWriter.hpp"
+#include <cstring> // std::memcpy
+#include <type_traits>
+
+// Declarative layout of TVW records. A record is a list of fields decoded into
+// members of T in file order, values that can't be decoded throw FormatError
+// tagged with their position in the file:
+//
+//   using TestNodeRecord = Record<
+//       Field<&TestNode::Current>,
+//       Field<&TestNode::Next>,
+//       Field<&TestNode::Flag>>;
+//   TestNodeRecord::Read(r, node);
+//   TestNodeRecord::Write(w, node);
+//
+// Fixed-layout records (no strings) have their size known at compile time and
+// are decoded from one contiguous block of bytes, fetched with a single bounds
+// check. A fixed run inside a variable record can be grouped into a nested
+// Record to get the same treatment.
+
+namespace Tebo
+{
+    template <typename M>
+    struct MemberTraits;
+
+    template <typename C, typename V>
+    struct MemberTraits<V C::*>
+    {
+        using Class = C;
+        using Value = V;
+    };
+
+    // Member stored as is; bools (and bool arrays) are validated to be 0 or 1
+    template <auto Member>
+    struct Field
+    {
+        using Value = typename MemberTraits<decltype(Member)>::Value;
+        using Element = std::remove_all_extents_t<Value>;
+
+        static_assert(std::is_trivially_copyable_v<Value>);
+        static_assert(!std::is_class_v<Element> || std::has_unique_object_representations_v<Element>,
+            "field type must have no padding");
+
+        static constexpr bool Fixed = true;
+        static constexpr size_t Size = sizeof(Value);
+
+        // pos is the position of p in the file
+        template <typename T>
+        static void Decode(uint8_t const *&p, T &obj, size_t pos)
+        {
+            if constexpr (std::is_same_v<Element, bool>)
+            {
+                auto const dst = reinterpret_cast<bool *>(&(obj.*Member));
+                for (size_t i = 0; i < Size; i++)
+                {
+                    if (p[i] > 1)
+                        StreamReader::Throw("Unexpected bool value", pos + i);
+                    dst[i] = p[i] != 0;
+                }
+            }
+            else
+                std::memcpy(&(obj.*Member), p, Size);
+            p += Size;
+        }
+
+        template <typename T>
+        static void Encode(uint8_t *&p, T const &obj)
+        {
+            std::memcpy(p, &(obj.*Member), Size);
+            p += Size;
+        }
+    };
+
+    // Member that must hold the given value
+    template <auto Member, auto Expected>
+    struct Const
+    {
+        static constexpr bool Fixed = true;
+        static constexpr size_t Size = Field<Member>::Size;
+
+        template <typename T>
+        static void Decode(uint8_t const *&p, T &obj, size_t pos)
+        {
+            Field<Member>::Decode(p, obj, pos);
+            if (!(obj.*Member == Expected))
+                StreamReader::Throw("Unexpected constant value", pos);
+        }
+
+        // writes the expected value whatever the member holds
+        template <typename T>
+        static void Encode(uint8_t *&p, T const &)
+        {
+            typename Field<Member>::Value const value = Expected;
+            std::memcpy(p, &value, Size);
+            p += Size;
+        }
+    };
+
+    // Length-prefixed string, up to 255 chars
+    template <auto Member>
+    struct String255
+    {
+        static constexpr bool Fixed = false;
+        static constexpr size_t Size = 1; // minimum
+
+        template <typename T>
+        static void Read(StreamReader &r, T &obj)
+        { obj.*Member = r.ReadStringView255(); }
+
+        template <typename T>
+        static void Write(StreamWriter &w, T const &obj)
+        { w.WriteString255(obj.*Member); }
+    };
+
+    template <typename... Fields>
+    struct Record
+    {
+        static constexpr bool Fixed = (Fields::Fixed && ...);
+        // exact for fixed records, minimum for variable ones
+        static constexpr size_t Size = (Fields::Size + ... + 0);
+
+        template <typename T>
+        static void Decode(uint8_t const *&p, T &obj, size_t pos)
+        {
+            static_assert(Fixed);
+            uint8_t const *const begin = p;
+            (Fields::Decode(p, obj, pos + size_t(p - begin)), ...);
+        }
+
+        template <typename T>
+        static void Read(StreamReader &r, T &obj)
+        {
+            if constexpr (Fixed)
+            {
+                size_t const pos = r.Tell();
+                uint8_t scratch[Size];
+                uint8_t const *p = r.Acquire(Size, scratch);
+                Decode(p, obj, pos);
+            }
+            else
+                (ReadField<Fields>(r, obj), ...);
+        }
+
+        template <typename T>
+        static void Encode(uint8_t *&p, T const &obj)
+        {
+            static_assert(Fixed);
+            (Fields::Encode(p, obj), ...);
+        }
+
+        template <typename T>
+        static void Write(StreamWriter &w, T const &obj)
+        {
+            if constexpr (Fixed)
+            {
+                uint8_t buffer[Size];
+                uint8_t *p = buffer;
+                Encode(p, obj);
+                w.Write(buffer, Size);
+            }
+            else
+                (WriteField<Fields>(w, obj), ...);
+        }
+
+    private:
+        template <typename F, typename T>
+        static void ReadField(StreamReader &r, T &obj)
+        {
+            if constexpr (F::Fixed)
+            {
+                size_t const pos = r.Tell();
+                uint8_t scratch[F::Size];
+                uint8_t const *p = r.Acquire(F::Size, scratch);
+                F::Decode(p, obj, pos);
+            }
+            else
+                F::Read(r, obj);
+        }
+
+        template <typename F, typename T>
+        static void WriteField(StreamWriter &w, T const &obj)
+        {
+            if constexpr (F::Fixed)
+            {
+                uint8_t buffer[F::Size];
+                uint8_t *p = buffer;
+                F::Encode(p, obj);
+                w.Write(buffer, F::Size);
+            }
+            else
+                F::Write(w, obj);
+        }
+    };
+} // namespace Tebo
@@ -5,46 +5,200 @@
 
 #include "Common.hpp"
 #include "Fixed32.hpp"
-#include <istream>
+#include "StreamSource.hpp"
+#include "StringPool.hpp"
+#include <algorithm> // std::min
+#include <cstring> // std::memcpy
+#include <memory> // std::unique_ptr
+#include <stdexcept> // std::runtime_error
+#include <string>
+#include <string_view>
+#include <type_traits> // std::is_trivially_copyable_v
+#include <vector>
 
 namespace Tebo
 {
+    // Malformed or truncated input
+    class FormatError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    class LoadStats;
+
     class StreamReader
     {
     protected:
-        std::istream &is;
-        std::streampos rPos;
+        StreamSource &src;
+        std::unique_ptr<StreamSource> ownedSrc;
+        // current window: [winBegin, winEnd) starts at winPos in the source
+        uint8_t const *winBegin = nullptr;
+        uint8_t const *winEnd = nullptr;
+        uint8_t const *cur = nullptr;
+        size_t winPos = 0;
+        StringPool *strings;
+
+        void Refill(size_t minSize)
+        {
+            size_t const pos = Tell();
+            auto const w = src.Fetch(pos, minSize);
+            winPos = pos;
+            winBegin = cur = w.Data;
+            winEnd = w.Data + w.Size;
+        }
+
+        void ReadSlow(uint8_t *dst, size_t size)
+        {
+            while (size)
+            {
+                if (cur == winEnd)
+                {
+                    Refill(size);
+                    if (cur == winEnd)
+                        Throw("Unexpected end of stream");
+                }
+                size_t const count = std::min(size, size_t(winEnd - cur));
+                std::memcpy(dst, cur, count);
+                cur += count;
+                dst += count;
+                size -= count;
+            }
+        }
 
     public:
-        StreamReader(std::istream &s) : is(s)
+        // Collects bytes and time per section and record type if set (see TeboStats.hpp)
+        LoadStats *Stats = nullptr;
+
+        // Strings read as views are stored in the pool if one is given, otherwise
+        // they point into the source, which has to be persistent
+        StreamReader(StreamSource &s, StringPool *pool = nullptr) :
+            src(s),
+            strings(pool)
+        {}
+
+        StreamReader(std::istream &s, StringPool *pool = nullptr) :
+            src(*new DirectSource(s)),
+            ownedSrc(&src),
+            strings(pool)
+        {}
+
+        StreamReader(StreamReader const &) = delete;
+        StreamReader &operator=(StreamReader const &) = delete;
+
+        size_t Tell() const { return winPos + size_t(cur - winBegin); }
+
+        void Seek(size_t pos)
+        {
+            if (winPos <= pos && pos <= winPos + size_t(winEnd - winBegin))
+            {
+                cur = winBegin + (pos - winPos);
+                return;
+            }
+            winPos = pos;
+            winBegin = winEnd = cur = nullptr;
+        }
+
+        size_t Size() const { return src.Size(); }
+
+        // Throws FormatError tagged with the given position
+        [[noreturn]] static void Throw(char const *what, size_t pos)
+        {
+            char msg[128];
+            std::snprintf(msg, sizeof(msg), "%s at addr[0x%08zX]", what, pos);
+            throw FormatError(msg);
+        }
+
+        // Throws FormatError tagged with the current position
+        [[noreturn]] void Throw(char const *what) const
+        { Throw(what, Tell()); }
+
+        size_t Remaining() const
+        {
+            size_t const pos = Tell(), size = Size();
+            return pos < size ? size - pos : 0;
+        }
+
+        // Throws unless count records of at least minSize bytes each fit in
+        // the rest of the input; call before reserving memory for them
+        void CheckCount(size_t count, size_t minSize) const
         {
-            rPos = Tell();
+            if (count > Remaining() / minSize)
+            {
+                if (src.Pending())
+                    throw InputPending();
+                Throw("Element count out of range");
+            }
         }
 
-        std::streampos Tell() { return is.tellg(); }
-        void Seek(size_t pos) { is.seekg(pos); }
+        uint32_t ReadCount(size_t minSize)
+        {
+            uint32_t const count = ReadU32();
+            CheckCount(count, minSize);
+            return count;
+        }
+
+        void Skip(size_t size)
+        {
+            if (size_t(winEnd - cur) >= size)
+            {
+                cur += size;
+                return;
+            }
+            Seek(Tell() + size);
+        }
 
         uint8_t ReadU8()
         {
             uint8_t r;
-            is.read((char *)&r, 1);
-            rPos = Tell();
+            Read(&r, 1);
             return r;
         }
 
         bool ReadBool8()
         {
             uint8_t const v = ReadU8();
-            R_ASSERT(v <= 1);
+            if (v > 1)
+                Throw("Unexpected bool value", Tell() - 1);
             return v;
         }
 
         template <typename T>
         void Read(T *dst, size_t count)
         {
-            std::streamsize const itemSize = sizeof(T);
-            is.read((char *)dst, itemSize*count);
-            rPos = Tell();
+            size_t const size = sizeof(T)*count;
+            if (size_t(winEnd - cur) >= size)
+            {
+                std::memcpy(dst, cur, size);
+                cur += size;
+                return;
+            }
+            ReadSlow(reinterpret_cast<uint8_t *>(dst), size);
+        }
+
+        // Returns the next size bytes as one block and moves past them; the bytes
+        // are copied to scratch only if they span two windows
+        uint8_t const *Acquire(size_t size, uint8_t *scratch)
+        {
+            if (size_t(winEnd - cur) >= size)
+            {
+                uint8_t const *const p = cur;
+                cur += size;
+                return p;
+            }
+            ReadSlow(scratch, size);
+            return scratch;
+        }
+
+        // Appends count packed records to dst in one copy
+        template <typename T>
+        void ReadArray(std::vector<T> &dst, size_t count)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            CheckCount(count, sizeof(T));
+            size_t const offset = dst.size();
+            dst.resize(offset + count);
+            Read(dst.data() + offset, count);
         }
 
         uint16_t ReadU16()
@@ -61,6 +215,15 @@ namespace Tebo
             return r;
         }
 
+        // Reads a value that must be equal to expected
+        uint32_t ExpectU32(uint32_t expected)
+        {
+            uint32_t const v = ReadU32();
+            if (v != expected)
+                Throw("Unexpected constant value", Tell() - sizeof(v));
+            return v;
+        }
+
         int32_t ReadS32()
         {
             int32_t r;
@@ -76,7 +239,11 @@ namespace Tebo
         }
 
         Vector2S ReadVec2S()
-        { return {ReadS32(), ReadS32()}; }
+        {
+            int32_t v[2];
+            Read(v, 2);
+            return {v[0], v[1]};
+        }
 
         std::string ReadString255()
         {
@@ -86,10 +253,27 @@ namespace Tebo
             Read(s.data(), size);
             return s;
         }
+
+        std::string_view ReadStringView255()
+        {
+            uint8_t const size = ReadU8();
+            if (size_t(winEnd - cur) < size)
+            {
+                Refill(size);
+                if (size_t(winEnd - cur) < size)
+                    Throw("Unexpected end of stream");
+            }
+            auto const s = reinterpret_cast<char const *>(cur);
+            cur += size;
+            if (strings)
+                return strings->Store(s, size);
+            R_ASSERT(src.Persistent());
+            return {s, size};
+        }
     };
 
     template <>
-    void StreamReader::Read(bool *dst, size_t count)
+    inline void StreamReader::Read(bool *dst, size_t count)
     {
         for (size_t i = 0; i < count; i++)
             dst[i] = ReadBool8();
@@ -0,0 +1,238 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include "FileMapping.hpp"
+#include <cstring> // std::memmove, std::memcpy
+#include <istream>
+#include <vector>
+
+namespace Tebo
+{
+    enum class ReaderBackend
+    {
+        Stream, // istream read per field
+        Buffered, // istream read in large blocks
+        Mapped, // whole file in memory
+        Push, // istream read in chunks and fed to PushReader, needn't be seekable
+    };
+
+    // Thrown by sources that are still receiving data when the bytes asked
+    // for haven't arrived yet; the read can be retried once they have
+    struct InputPending
+    {};
+
+    // Supplies the bytes StreamReader decodes from, one contiguous window at a time.
+    class StreamSource
+    {
+    public:
+        struct Window
+        {
+            uint8_t const *Data;
+            size_t Size;
+        };
+
+        virtual ~StreamSource() = default;
+        virtual size_t Size() const = 0;
+        // True if the bytes don't depend on an external stream and can be
+        // kept around after reading
+        virtual bool Persistent() const { return false; }
+        // True if more data may still arrive past Size()
+        virtual bool Pending() const { return false; }
+        // Returns bytes starting at pos: at least minSize of them unless the
+        // end of data comes first. The window stays valid until the next call.
+        virtual Window Fetch(size_t pos, size_t minSize) = 0;
+    };
+
+    // Whole input in memory: either a file mapping or a buffer filled in one read.
+    class MemorySource final : public StreamSource
+    {
+    private:
+        FileMapping mapping;
+        std::vector<uint8_t> buffer;
+        uint8_t const *data = nullptr;
+        size_t size = 0;
+
+    public:
+        bool Map(char const *path)
+        {
+            if (!mapping.Open(path))
+                return false;
+            data = mapping.Data();
+            size = mapping.Size();
+            return true;
+        }
+
+        void Load(std::istream &s)
+        {
+            auto const pos = s.tellg();
+            s.seekg(0, std::ios::end);
+            buffer.resize(size_t(s.tellg() - pos));
+            s.seekg(pos);
+            s.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+            buffer.resize(size_t(s.gcount()));
+            data = buffer.data();
+            size = buffer.size();
+        }
+
+        virtual size_t Size() const override { return size; }
+        virtual bool Persistent() const override { return true; }
+
+        virtual Window Fetch(size_t pos, size_t) override
+        {
+            if (pos >= size)
+                return {data + size, 0};
+            return {data + pos, size - pos};
+        }
+    };
+
+    // Reads the stream in large blocks.
+    class BufferedSource final : public StreamSource
+    {
+    private:
+        std::istream &is;
+        size_t size;
+        size_t streamPos;
+        std::vector<uint8_t> buffer;
+        size_t bufferPos = 0; // stream offset of buffer[0]
+        size_t filled = 0;
+
+    public:
+        static constexpr size_t DefaultBlockSize = 1 << 20;
+
+        BufferedSource(std::istream &s, size_t blockSize = DefaultBlockSize) :
+            is(s),
+            buffer(blockSize)
+        {
+            streamPos = size_t(is.tellg());
+            is.seekg(0, std::ios::end);
+            size = size_t(is.tellg());
+            is.seekg(streamPos);
+        }
+
+        virtual size_t Size() const override { return size; }
+
+        virtual Window Fetch(size_t pos, size_t minSize) override
+        {
+            if (bufferPos <= pos && pos < bufferPos + filled)
+            { // keep the unread tail
+                size_t const tail = bufferPos + filled - pos;
+                if (tail >= minSize)
+                    return {buffer.data() + pos - bufferPos, tail};
+                std::memmove(buffer.data(), buffer.data() + pos - bufferPos, tail);
+                filled = tail;
+            }
+            else
+            {
+                if (pos != streamPos)
+                {
+                    is.clear();
+                    is.seekg(pos);
+                    streamPos = pos;
+                }
+                filled = 0;
+            }
+            bufferPos = pos;
+            if (buffer.size() < minSize)
+                buffer.resize(minSize);
+            is.read(reinterpret_cast<char *>(buffer.data() + filled), buffer.size() - filled);
+            size_t const count = size_t(is.gcount());
+            streamPos += count;
+            filled += count;
+            return {buffer.data(), filled};
+        }
+    };
+
+    // Reads exactly what was asked for on every call, like plain istream::read.
+    class DirectSource final : public StreamSource
+    {
+    private:
+        std::istream &is;
+        size_t size;
+        size_t streamPos;
+        std::vector<uint8_t> buffer;
+
+    public:
+        DirectSource(std::istream &s) : is(s)
+        {
+            streamPos = size_t(is.tellg());
+            is.seekg(0, std::ios::end);
+            size = size_t(is.tellg());
+            is.seekg(streamPos);
+        }
+
+        virtual size_t Size() const override { return size; }
+
+        virtual Window Fetch(size_t pos, size_t minSize) override
+        {
+            if (pos != streamPos)
+            {
+                is.clear();
+                is.seekg(pos);
+                streamPos = pos;
+            }
+            if (buffer.size() < minSize)
+                buffer.resize(minSize);
+            is.read(reinterpret_cast<char *>(buffer.data()), minSize);
+            size_t const count = size_t(is.gcount());
+            streamPos += count;
+            return {buffer.data(), count};
+        }
+    };
+
+    // Input handed over in chunks as it arrives. Fetching past the received
+    // data throws InputPending until the input is closed. Bytes before the
+    // position passed to Release are dropped; windows stay valid until the
+    // next Append or Release.
+    class ChunkSource final : public StreamSource
+    {
+    private:
+        std::vector<uint8_t> buffer;
+        size_t base = 0; // input offset of buffer[0]
+        size_t released = 0; // bytes at the start of buffer not needed anymore
+        bool closed = false;
+
+    public:
+        void Append(void const *data, size_t size)
+        {
+            R_ASSERT(!closed);
+            size_t const offset = buffer.size();
+            buffer.resize(offset + size);
+            std::memcpy(buffer.data() + offset, data, size);
+        }
+
+        void Close() { closed = true; }
+
+        void Release(size_t pos)
+        {
+            R_ASSERT(base <= pos && pos <= Size());
+            released = pos - base;
+            // compact once the dropped bytes outweigh the kept ones
+            if (released > buffer.size() - released)
+            {
+                buffer.erase(buffer.begin(), buffer.begin() + released);
+                base = pos;
+                released = 0;
+            }
+        }
+
+        virtual size_t Size() const override { return base + buffer.size(); }
+        virtual bool Pending() const override { return !closed; }
+
+        virtual Window Fetch(size_t pos, size_t minSize) override
+        {
+            R_ASSERT(pos >= base + released);
+            size_t const size = Size();
+            if (pos > size || size - pos < minSize)
+            {
+                if (!closed)
+                    throw InputPending();
+                if (pos > size)
+                    pos = size;
+            }
+            return {buffer.data() + (pos - base), size - pos};
+        }
+    };
+} // namespace Tebo
@@ -0,0 +1,83 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include "Fixed32.hpp"
+#include <cstring> // std::memcpy
+#include <ostream>
+#include <string_view>
+#include <type_traits> // std::is_trivially_copyable_v
+#include <vector>
+
+namespace Tebo
+{
+    // Binary counterpart of StreamReader: little-endian fields, buffered in
+    // large blocks before they go to the stream
+    class StreamWriter
+    {
+    private:
+        std::ostream &os;
+        std::vector<uint8_t> buffer;
+        size_t written = 0;
+
+    public:
+        static constexpr size_t BufferSize = 1 << 20;
+
+        StreamWriter(std::ostream &s) : os(s)
+        { buffer.reserve(BufferSize); }
+
+        StreamWriter(StreamWriter const &) = delete;
+        StreamWriter &operator=(StreamWriter const &) = delete;
+
+        ~StreamWriter()
+        { Flush(); }
+
+        size_t Tell() const { return written + buffer.size(); }
+
+        void Flush()
+        {
+            os.write(reinterpret_cast<char const *>(buffer.data()), buffer.size());
+            written += buffer.size();
+            buffer.clear();
+        }
+
+        template <typename T>
+        void Write(T const *src, size_t count)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            size_t const size = sizeof(T)*count;
+            if (buffer.size() + size > BufferSize)
+                Flush();
+            if (size >= BufferSize)
+            {
+                os.write(reinterpret_cast<char const *>(src), size);
+                written += size;
+                return;
+            }
+            size_t const offset = buffer.size();
+            buffer.resize(offset + size);
+            std::memcpy(buffer.data() + offset, src, size);
+        }
+
+        template <typename T>
+        void WriteArray(std::vector<T> const &src)
+        { Write(src.data(), src.size()); }
+
+        void WriteU8(uint8_t v) { Write(&v, 1); }
+        void WriteBool8(bool v) { WriteU8(v ? 1 : 0); }
+        void WriteU16(uint16_t v) { Write(&v, 1); }
+        void WriteU32(uint32_t v) { Write(&v, 1); }
+        void WriteS32(int32_t v) { Write(&v, 1); }
+        void WriteFloat(float v) { Write(&v, 1); }
+        void WriteVec2S(Vector2S v) { Write(&v, 1); }
+
+        void WriteString255(std::string_view s)
+        {
+            R_ASSERT(s.size() <= 255);
+            WriteU8(uint8_t(s.size()));
+            Write(s.data(), s.size());
+        }
+    };
+} // namespace Tebo
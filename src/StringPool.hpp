@@ -0,0 +1,71 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include <algorithm> // std::max
+#include <cstring> // std::memcpy
+#include <memory> // std::unique_ptr
+#include <string_view>
+#include <utility> // std::exchange
+#include <vector>
+
+// Append-only string storage: stored strings keep their address until the pool
+// is destroyed, so std::string_view can be handed out instead of std::string.
+class StringPool final
+{
+private:
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char *cur = nullptr;
+    size_t left = 0;
+
+public:
+    static constexpr size_t ChunkSize = 64 << 10;
+
+    StringPool() = default;
+    StringPool(StringPool const &) = delete;
+    StringPool &operator=(StringPool const &) = delete;
+
+    StringPool(StringPool &&that) noexcept :
+        chunks(std::move(that.chunks)),
+        cur(std::exchange(that.cur, nullptr)),
+        left(std::exchange(that.left, 0))
+    {}
+
+    StringPool &operator=(StringPool &&that) noexcept
+    {
+        chunks = std::move(that.chunks);
+        cur = std::exchange(that.cur, nullptr);
+        left = std::exchange(that.left, 0);
+        return *this;
+    }
+
+    std::string_view Store(char const *s, size_t size)
+    {
+        if (!size)
+            return {};
+        if (size > left)
+        {
+            size_t const chunkSize = std::max(size, ChunkSize);
+            chunks.push_back(std::make_unique<char[]>(chunkSize));
+            cur = chunks.back().get();
+            left = chunkSize;
+        }
+        char *const dst = cur;
+        std::memcpy(dst, s, size);
+        cur += size;
+        left -= size;
+        return {dst, size};
+    }
+
+    // Takes ownership of the strings stored in another pool
+    void Merge(StringPool &&that)
+    {
+        for (auto &chunk : that.chunks)
+            chunks.push_back(std::move(chunk));
+        that.chunks.clear();
+        that.cur = nullptr;
+        that.left = 0;
+    }
+};
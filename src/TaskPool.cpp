@@ -0,0 +1,96 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#include "TaskPool.hpp"
+
+uint32_t TaskPool::ResolveJobs(uint32_t jobs)
+{
+    if (jobs)
+        return jobs;
+    uint32_t const hwThreads = std::thread::hardware_concurrency();
+    return hwThreads ? hwThreads : 1;
+}
+
+TaskPool::TaskPool(uint32_t jobs)
+{
+    jobs = ResolveJobs(jobs);
+    if (jobs < 2)
+        return;
+    workers.reserve(jobs);
+    for (uint32_t i = 0; i < jobs; i++)
+        workers.emplace_back([this]() { Work(); });
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void TaskPool::Execute(std::function<void()> &task)
+{
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+            error = std::current_exception();
+    }
+}
+
+void TaskPool::Work()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return stop || !tasks.empty(); });
+            if (tasks.empty())
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        Execute(task);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        done.notify_all();
+    }
+}
+
+void TaskPool::Run(std::function<void()> task)
+{
+    if (workers.empty())
+    {
+        Execute(task);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push_back(std::move(task));
+        pending++;
+    }
+    wake.notify_one();
+}
+
+void TaskPool::Wait()
+{
+    std::exception_ptr e;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return !pending; });
+        std::swap(e, error);
+    }
+    if (e)
+        std::rethrow_exception(e);
+}
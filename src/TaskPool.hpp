@@ -0,0 +1,54 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include <condition_variable>
+#include <deque>
+#include <exception> // std::exception_ptr
+#include <functional> // std::function
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running queued tasks.
+// With a single job, tasks run inline on the calling thread.
+class TaskPool final
+{
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    size_t pending = 0;
+    bool stop = false;
+    std::exception_ptr error;
+
+    void Work();
+    void Execute(std::function<void()> &task);
+
+public:
+    // 0 jobs : one per hardware thread
+    explicit TaskPool(uint32_t jobs = 0);
+    TaskPool(TaskPool const &) = delete;
+    TaskPool &operator=(TaskPool const &) = delete;
+    ~TaskPool();
+
+    uint32_t Jobs() const { return workers.empty() ? 1 : uint32_t(workers.size()); }
+
+    void Run(std::function<void()> task);
+    // Waits for all queued tasks; rethrows the first exception thrown by a task
+    void Wait();
+
+    // Runs fn(i) for every i in [0, count) and waits for completion
+    template <typename Fn>
+    void ForEach(size_t count, Fn const &fn)
+    {
+        for (size_t i = 0; i < count; i++)
+            Run([&fn, i]() { fn(i); });
+        Wait();
+    }
+
+    static uint32_t ResolveJobs(uint32_t jobs);
+};
@@ -4,37 +4,42 @@
 #include "TeboBoard.hpp"
 #include "BoardFormatRegistrator.hpp"
 #include "CBF/Board.hpp"
+#include "TeboPushReader.hpp"
+#include "TeboRecords.hpp"
+#include "TeboStats.hpp"
+#include "TaskPool.hpp"
+#include <algorithm> // std::find_if, std::copy
+#include <cstdlib> // std::strtoul
+#include <cstring> // std::strcmp
+#include <tuple> // std::tuple_size_v
 
 namespace Tebo
 {
-    std::unique_ptr<Shape> Shape::Load(StreamReader &r)
+    void Shape::Load(StreamReader &r, ShapePool &pool)
     {
-        {
-            uint32_t one = r.ReadU32();
-            R_ASSERT(one == 1);
-        }
-        auto const size = r.ReadVec2S();
-        auto const type = ShapeType(r.ReadU32());
-        switch (type)
+        r.ExpectU32(1);
+        Size = r.ReadVec2S();
+        Type = ShapeType(r.ReadU32());
+        switch (Type)
         {
         case ShapeType::Round:
         {
-            auto const skip = r.ReadVec2S();
-            return std::make_unique<Round>(size);
+            r.Read(Params, 2);
+            break;
         }
         case ShapeType::Rect:
         {
-            auto const turn = r.ReadFloat();
-            auto const skip = r.ReadS32();
-            return std::make_unique<Rect>(size, turn);
+            Turn = r.ReadFloat();
+            Params[0] = r.ReadS32();
+            break;
         }
         case ShapeType::Poly:
         {
-            auto const skip = r.ReadU32();
-            auto const name = r.ReadString255();
-            auto shape = std::make_unique<Poly>(size, name);
-            shape->BBox.Min = r.ReadVec2S();
-            shape->BBox.Max = r.ReadVec2S();
+            Params[0] = r.ReadS32();
+            Name = r.ReadStringView255();
+            BBox.Min = r.ReadVec2S();
+            BBox.Max = r.ReadVec2S();
+            FirstLine = uint32_t(pool.Lines.size());
             auto subObjCount = r.ReadU32();
             for (uint32_t i = 0; i < subObjCount; i++)
             {
@@ -43,53 +48,90 @@ namespace Tebo
                 {
                 case 2: // poly
                 {
-                    R_ASSERT(shape->Vertices.empty());
-                    r.Read(shape->Flags, 3);
-                    uint32_t const vertexCount = r.ReadU32();
-                    shape->Vertices.reserve(vertexCount);
-                    for (uint32_t i = 0; i < vertexCount; i++)
-                        shape->Vertices.push_back(r.ReadVec2S());
+                    if (VertexCount)
+                        r.Throw("Duplicate shape vertex list");
+                    VertexListIndex = int32_t(i);
+                    r.Read(Flags, 3);
+                    FirstVertex = uint32_t(pool.Vertices.size());
+                    VertexCount = r.ReadU32();
+                    r.ReadArray(pool.Vertices, VertexCount);
                     break;
                 }
                 case 5: // line
                 {
-                    shape->Lines.emplace_back().Load(r);
+                    pool.Lines.emplace_back().Load(r);
                     break;
                 }
                 default:
-                    R_ASSERT(!"Unrecognized subobject type");
-                    break;
+                    r.Throw("Unrecognized subobject type");
                 }
             }
-            return shape;
+            LineCount = uint32_t(pool.Lines.size()) - FirstLine;
+            break;
         }
         case ShapeType::RoundRect:
         {
-            auto const turn = r.ReadFloat();
-            auto const cornerRadius = r.ReadS32();
-            return std::make_unique<RoundRect>(size, cornerRadius, turn);
+            Turn = r.ReadFloat();
+            CornerRadius = r.ReadS32();
+            break;
         }
         default:
-            R_ASSERT(!"Unrecognized shape type");
-            return nullptr;
+            r.Throw("Unrecognized shape type");
+        }
+    }
+
+    void Shape::Skim(StreamReader &r)
+    {
+        r.Skip(4 + 8); // one, size
+        auto const type = ShapeType(r.ReadU32());
+        switch (type)
+        {
+        case ShapeType::Round:
+        case ShapeType::Rect:
+        case ShapeType::RoundRect:
+            r.Skip(8);
+            break;
+        case ShapeType::Poly:
+        {
+            r.Skip(4);
+            r.Skip(r.ReadU8()); // name
+            r.Skip(16); // bbox
+            uint32_t const subObjCount = r.ReadU32();
+            for (uint32_t i = 0; i < subObjCount; i++)
+            {
+                switch (r.ReadU32())
+                {
+                case 2: // poly
+                    r.Skip(12);
+                    r.Skip(size_t(r.ReadU32())*sizeof(Vector2S));
+                    break;
+                case 5: // line
+                    r.Skip(ShapeLine::RecordSize);
+                    break;
+                default:
+                    r.Throw("Unrecognized subobject type");
+                }
+            }
+            break;
+        }
+        default:
+            r.Throw("Unrecognized shape type");
         }
     }
 
-    void Poly::Line::Load(StreamReader &r)
+    void ShapeLine::Load(StreamReader &r)
     {
-        Param1 = r.ReadU32();
-        R_ASSERT(Param1 == 1);
-        Param2 = r.ReadU32();
-        R_ASSERT(Param2 == 0);
-        Param3 = r.ReadU32();
-        R_ASSERT(Param3 == 0);
+        Param1 = r.ExpectU32(1);
+        Param2 = r.ExpectU32(0);
+        Param3 = r.ExpectU32(0);
         Start = r.ReadVec2S();
         End = r.ReadVec2S();
         Width = r.ReadS32();
     }
 
-    static void DecodeString(std::string &s)
+    std::string TvwHeader::Decode(std::string_view encoded)
     {
+        std::string s(encoded);
         for (size_t i = 0; i < s.size(); i++)
         {
             char c = s[i];
@@ -128,18 +170,16 @@ namespace Tebo
                 continue;
             }
         }
+        return s;
     }
 
     void TvwHeader::Load(StreamReader &r)
     {
-        Type = r.ReadString255();
-        DecodeString(Type);
+        Type = r.ReadStringView255();
         Const1 = r.ReadU32();
-        Customer = r.ReadString255();
-        DecodeString(Customer);
+        Customer = r.ReadStringView255();
         Const2 = r.ReadU8();
-        Date = r.ReadString255();
-        DecodeString(Date);
+        Date = r.ReadStringView255();
         r.Read(Const3, 3);
         Size1 = r.ReadU32();
         Size2 = r.ReadU32();
@@ -186,100 +226,71 @@ namespace Tebo
         // 3, 2, 1 # logic layer
         // 1, 2, 1 # thru layer (from 0 to 0)
         uint32_t const pos(r.Tell());
-        r.Read(Magic, 2);
-        R_ASSERT(Magic[0] == 2 && Magic[1] == 1);
-        Name = r.ReadString255();
-        InitialName = r.ReadString255();
-        InitialPath = r.ReadString255();
+        Magic[0] = r.ExpectU32(2);
+        Magic[1] = r.ExpectU32(1);
+        Name = r.ReadStringView255();
+        InitialName = r.ReadStringView255();
+        InitialPath = r.ReadStringView255();
         Type = LayerType(r.ReadU32());
+        if (Type > LayerType::Roul)
+            r.Throw("Unrecognized layer type", r.Tell() - sizeof(Type));
         PadColor = r.ReadU32();
         LineColor = r.ReadU32();
-        printf("- loading object name[%s] type[%s] addr[0x%08X]\n",
-            Name.c_str(), LayerTypeToString(Type), pos);
+        printf("- loading object name[%.*s] type[%s] addr[0x%08X]\n",
+            int(Name.size()), Name.data(), LayerTypeToString(Type), pos);
+    }
+
+    void Object::Skim(StreamReader &r)
+    {
+        r.Skip(8); // magic
+        for (uint32_t i = 0; i < 3; i++) // names
+            r.Skip(r.ReadU8());
+        r.Skip(12); // type, colors
     }
 
     void TestPoint::Load(StreamReader &r)
     {
-        Flag1 = r.ReadBool8();
-        P1 = r.ReadS32();
-        Handle = r.ReadS32();
-        P2 = r.ReadS32();
-        P3 = r.ReadS32();
-        Pos = r.ReadVec2S();
+        TestPointRecord::Read(r, *this);
         ValidatePos(Pos);
-        P4 = r.ReadS32();
-        Flag2 = r.ReadBool8();
-        P5 = r.ReadS32();
-        P6 = r.ReadS32();
-        N = r.ReadS32();
     }
 
     void TestPoint2::Load(StreamReader &r)
     {
-        P1 = r.ReadS32();
-        Handle = r.ReadS32();
-        P2 = r.ReadS32();
-        Pos = r.ReadVec2S();
+        TestPoint2Record::Read(r, *this);
         ValidatePos(Pos);
-        Pos1 = r.ReadVec2S();
-        Pos2 = r.ReadVec2S();
-        Flag1 = r.ReadBool8();
-        Flag2 = r.ReadBool8();
-        Flag3 = r.ReadBool8();
-        Nail = r.ReadU32();
-        Param = r.ReadS32();
-        Flag4 = r.ReadBool8();
-        Flag5 = r.ReadBool8();
-        Flag6 = r.ReadBool8();
-        N = r.ReadS32();
     }
 
     void TestNode::Load(StreamReader &r)
-    {
-        Current = r.ReadU32();
-        Next = r.ReadU32();
-        Flag = r.ReadBool8();
-    }
+    { TestNodeRecord::Read(r, *this); }
 
     void UnknownItem::Load(StreamReader &r)
-    {
-        Name = r.ReadString255();
-        Pos = r.ReadVec2S();
-        Z1 = r.ReadS32();
-        Param1 = r.ReadS32();
-        Param2 = r.ReadS32();
-        Param3 = r.ReadS32();
-        Z2 = r.ReadS32();
-        Z3 = r.ReadS32();
-        r.Read(Flags, 3);
-        Param4 = r.ReadS32();
-    }
+    { UnknownItemRecord::Read(r, *this); }
 
     void LogicLayer::LoadShapes(StreamReader &r)
     {
+        StatScope stat(r, StatId::Shapes);
         // this is actually max dcode, not a 'count'
         uint32_t shapeCount = r.ReadU32();
         if (!shapeCount)
             return;
-        R_ASSERT(shapeCount >= 10);
+        if (shapeCount < 10)
+            r.Throw("Shape count out of range");
         shapeCount -= 10;
-        for (uint32_t i = 0; i < shapeCount; i++)
-        {
-            std::unique_ptr<Shape> shape = Shape::Load(r);
-            R_ASSERT(shape != nullptr);
-            Shapes.push_back(std::move(shape));
-        }
+        r.CheckCount(shapeCount, Shape::MinSize);
+        stat.Items = shapeCount;
+        Shapes.resize(shapeCount);
+        for (auto &shape : Shapes)
+            shape.Load(r, ShapeData);
     }
 
     void LogicLayer::LoadPads(StreamReader &r)
     {
-        uint32_t const instanceCount = r.ReadU32();
+        StatScope stat(r, StatId::Pads);
+        uint32_t const instanceCount = r.ReadCount(Pad::MinSize);
+        stat.Items = instanceCount;
         if (!instanceCount)
             return;
-        {
-            uint32_t const two = r.ReadU32();
-            R_ASSERT(two == 2);
-        }
+        r.ExpectU32(2);
         Pads.reserve(instanceCount);
         for (uint32_t i = 0; i < instanceCount; i++)
         {
@@ -290,31 +301,34 @@ namespace Tebo
             obj.IsExposed = r.ReadBool8();
             obj.IsCopper = r.ReadBool8();
             obj.TestpointParam = r.ReadU8();
-            R_ASSERT(obj.DCode-10 < Shapes.size());
-            obj.Shape = Shapes[obj.DCode-10].get();
+            if (obj.DCode-10 >= Shapes.size())
+                r.Throw("DCode out of range");
+            obj.Shape = obj.DCode-10;
             if (obj.IsCopper)
             {
                 obj.IsSomething = r.ReadBool8();
                 if (obj.TestpointParam == 1)
-                    r.Read(obj.TestPoint.Data12, 12);
+                    r.Read(PadTestPoints.Add(i).Data12, 12);
                 if (obj.IsExposed || obj.IsSomething)
-                { // bbox of exposed area of this pad without rotation
-                    obj.Exposed.Min = r.ReadVec2S();
-                    obj.Exposed.Max = r.ReadVec2S();
+                {
+                    auto &exposed = PadExposedAreas.Add(i);
+                    exposed.Min = r.ReadVec2S();
+                    exposed.Max = r.ReadVec2S();
                 }
                 obj.HasHole = r.ReadBool8();
                 obj.TailParam = r.ReadU8();
                 if (obj.HasHole)
                 {
-                    r.Read(obj.Hole.Data7, 7);
-                    obj.Hole.Size = r.ReadVec2S();
-                    obj.Hole.Param = r.ReadU8();
+                    auto &hole = PadHoles.Add(i);
+                    r.Read(hole.Data7, 7);
+                    hole.Size = r.ReadVec2S();
+                    hole.Param = r.ReadU8();
                 }
             }
-            else // not copper
+            else if (obj.IsExposed || obj.TestpointParam == 1)
             {
-                R_ASSERT(!obj.IsExposed && obj.TestpointParam != 1); // not expected
                 // no exposed copper => no extra data
+                r.Throw("Unexpected non-copper pad flags");
             }
             Pads.push_back(std::move(obj));
         }
@@ -322,20 +336,20 @@ namespace Tebo
 
     void LogicLayer::LoadLines(StreamReader &r)
     {
-        uint32_t const instanceCount = r.ReadU32();
+        StatScope stat(r, StatId::Lines);
+        uint32_t const instanceCount = r.ReadCount(Line::RecordSize);
+        stat.Items = instanceCount;
         if (!instanceCount)
             return;
-        {
-            uint32_t const zero = r.ReadU32();
-            R_ASSERT(!zero);
-        }
+        r.ExpectU32(0);
         Lines.reserve(instanceCount);
         for (uint32_t i = 0; i < instanceCount; i++)
         {
             Line obj;
             obj.Net = r.ReadS32();
             obj.DCode = r.ReadU32();
-            R_ASSERT(obj.DCode-10 < Shapes.size());
+            if (obj.DCode-10 >= Shapes.size())
+                r.Throw("DCode out of range");
             obj.StartPos = r.ReadVec2S();
             obj.EndPos = r.ReadVec2S();
             Lines.push_back(std::move(obj));
@@ -344,20 +358,20 @@ namespace Tebo
 
     void LogicLayer::LoadArcs(StreamReader &r)
     {
-        uint32_t const instanceCount = r.ReadU32();
+        StatScope stat(r, StatId::Arcs);
+        uint32_t const instanceCount = r.ReadCount(Arc::RecordSize);
+        stat.Items = instanceCount;
         if (!instanceCount)
             return;
-        {
-            uint32_t zero = r.ReadU32();
-            R_ASSERT(!zero);
-        }
+        r.ExpectU32(0);
         Arcs.reserve(instanceCount);
         for (uint32_t i = 0; i < instanceCount; i++)
         {
             Arc obj;
             obj.Net = r.ReadS32();
             obj.DCode = r.ReadU32();
-            R_ASSERT(obj.DCode-10 < Shapes.size());
+            if (obj.DCode-10 >= Shapes.size())
+                r.Throw("DCode out of range");
             obj.Pos = r.ReadVec2S();
             obj.Radius = r.ReadS32();
             obj.StartAngle = r.ReadFloat();
@@ -368,24 +382,21 @@ namespace Tebo
 
     void LogicLayer::LoadSurfaces(StreamReader &r)
     {
-        uint32_t const instanceCount = r.ReadU32();
+        StatScope stat(r, StatId::Surfaces);
+        uint32_t const instanceCount = r.ReadCount(Surface::MinSize);
+        stat.Items = instanceCount;
         if (!instanceCount)
             return;
-        {
-            uint32_t two = r.ReadU32();
-            R_ASSERT(two == 2);
-        }
+        r.ExpectU32(2);
         Surfaces.reserve(instanceCount);
         for (uint32_t i = 0; i < instanceCount; i++)
         {
             Surface obj;
             obj.Net = r.ReadS32();
             obj.EdgeCount = r.ReadU32();
-            obj.Vertices.reserve(obj.EdgeCount);
-            for (uint32_t vi = 0; vi < obj.EdgeCount; vi++)
-                obj.Vertices.push_back(r.ReadVec2S());
+            r.ReadArray(obj.Vertices, obj.EdgeCount);
             obj.LineWidth = r.ReadS32();
-            obj.VoidCount = r.ReadU32();
+            obj.VoidCount = r.ReadCount(Cutout::MinSize);
             if (obj.VoidCount)
             {
                 obj.Voids.reserve(obj.VoidCount);
@@ -393,11 +404,10 @@ namespace Tebo
                 {
                     Cutout cutout;
                     cutout.Tag = r.ReadU32();
-                    R_ASSERT(cutout.Tag <= 1);
+                    if (cutout.Tag > 1)
+                        r.Throw("Unrecognized cutout tag");
                     cutout.EdgeCount = r.ReadU32();
-                    cutout.Vertices.reserve(cutout.EdgeCount);
-                    for (uint32_t ci = 0; ci < cutout.EdgeCount; ci++)
-                        cutout.Vertices.push_back(r.ReadVec2S());
+                    r.ReadArray(cutout.Vertices, cutout.EdgeCount);
                     obj.Voids.push_back(std::move(cutout));
                 }
                 obj.VoidFlags = r.ReadU32();
@@ -408,23 +418,24 @@ namespace Tebo
 
     void LogicLayer::LoadUnknownItems(StreamReader &r)
     {
-        UnknownItemCount = r.ReadU32();
+        StatScope stat(r, StatId::UnknownItems);
+        UnknownItemCount = r.ReadCount(UnknownItemRecord::Size);
+        stat.Items = UnknownItemCount;
         UnknownItemsParam = r.ReadU32();
         if (UnknownItemCount)
         {
             UnknownItems.reserve(UnknownItemCount);
             for (uint32_t i = 0; i < UnknownItemCount; i++)
                 UnknownItems.emplace_back().Load(r);
-            uint32_t const skip = r.ReadU32();
-            R_ASSERT(skip == 0);
+            r.ExpectU32(0);
         }
-        uint32_t const skip = r.ReadU32();
-        R_ASSERT(skip == 7);
+        r.ExpectU32(7);
     }
 
     void LogicLayer::LoadTestpoints(StreamReader &r)
     {
-        TpCount = r.ReadU32();
+        StatScope stat(r, StatId::TestPoints);
+        TpCount = r.ReadCount(TestPoint::RecordSize);
         TestPoints.reserve(TpCount);
         for (uint32_t i = 0; i < TpCount; i++)
         {
@@ -432,13 +443,9 @@ namespace Tebo
             obj.Load(r);
             TestPoints.push_back(obj);
         }
-        {
-            uint32_t skip = r.ReadU32();
-            R_ASSERT(skip == 0);
-            skip = r.ReadU32();
-            R_ASSERT(skip == 4);
-        }
-        TPS2Size = r.ReadU32();
+        r.ExpectU32(0);
+        r.ExpectU32(4);
+        TPS2Size = r.ReadCount(TestPoint2::RecordSize);
         TPS2Param = r.ReadU32();
         TestPoints2.reserve(TPS2Size);
         for (uint32_t i = 0; i < TPS2Size; i++)
@@ -447,7 +454,7 @@ namespace Tebo
             obj.Load(r);
             TestPoints2.push_back(obj);
         }
-        TPS3Size = r.ReadU32();
+        TPS3Size = r.ReadCount(TestPoint2::RecordSize);
         TPS3Param = r.ReadU32();
         TestPoints3.reserve(TPS3Size);
         for (uint32_t i = 0; i < TPS3Size; i++)
@@ -456,7 +463,7 @@ namespace Tebo
             obj.Load(r);
             TestPoints3.push_back(obj);
         }
-        TestSequenceSize = r.ReadU32();
+        TestSequenceSize = r.ReadCount(TestNode::RecordSize);
         TestSequenceParam = r.ReadU32();
         TestSequence.reserve(TestSequenceSize);
         for (uint32_t i = 0; i < TestSequenceSize; i++)
@@ -465,13 +472,11 @@ namespace Tebo
             obj.Load(r);
             TestSequence.push_back(obj);
         }
+        stat.Items = size_t(TpCount) + TPS2Size + TPS3Size + TestSequenceSize;
         if (TestSequenceParam == 1)
         {
-            uint32_t skip[3];
-            r.Read(skip, 3);
-            R_ASSERT(skip[0] == 0);
-            R_ASSERT(skip[1] == 0);
-            R_ASSERT(skip[2] == 0);
+            for (uint32_t i = 0; i < 3; i++)
+                r.ExpectU32(0);
         }
     }
 
@@ -483,24 +488,21 @@ namespace Tebo
         {
             bool extraData = false;
             {
-                auto const skip1 = r.ReadU32();
+                DataOrder = r.ReadU32();
                 // NOTE: this might be incorrect way to determine data order
                 // (maybe it has to be bound to layer type?)
-                switch (skip1)
+                switch (DataOrder)
                 {
                 default:
-                    R_ASSERT(!"Unrecognized data order");
-                    break;
+                    r.Throw("Unrecognized data order", r.Tell() - sizeof(DataOrder));
                 case 1: // normal: shapes, [these flags], pads, lines, arcs, surfaces
                     break;
                 case 2: // extra data: shapes, [these flags], pads, lines(0), arcs(0), surfaces, int32[4], lines, arcs
                     extraData = true;
                     break;
                 }
-                auto const skip2 = r.ReadU32();
-                R_ASSERT(skip2 == 0);
-                auto const skip3 = r.ReadU32();
-                R_ASSERT(skip3 == 1);
+                r.ExpectU32(0);
+                r.ExpectU32(1);
             }
             LoadPads(r);
             LoadLines(r);
@@ -508,21 +510,123 @@ namespace Tebo
             LoadSurfaces(r);
             if (extraData)
             {
-                uint32_t skip3[4];
-                r.Read(skip3, 4);
-                printf("* skip: %u, %u, %u, %u\n",
-                    skip3[0], skip3[1], skip3[2], skip3[3]);
+                r.Read(ExtraParams, 4);
+                printf("* name[%.*s] skip: %u, %u, %u, %u\n", int(Name.size()), Name.data(),
+                    ExtraParams[0], ExtraParams[1], ExtraParams[2], ExtraParams[3]);
                 // reload lines and arcs
+                size_t const lineCount = Lines.size();
+                size_t const arcCount = Arcs.size();
                 LoadLines(r);
                 LoadArcs(r);
-                uint32_t const skip4 = r.ReadU32();
-                R_ASSERT(skip4 == 0);
+                ExtraLineCount = uint32_t(Lines.size() - lineCount);
+                ExtraArcCount = uint32_t(Arcs.size() - arcCount);
+                r.ExpectU32(0);
             }
         }
         LoadUnknownItems(r);
         LoadTestpoints(r);
     }
 
+    void LogicLayer::Skim(StreamReader &r)
+    {
+        Object::Skim(r);
+        // max dcode, as in LoadShapes: the rest of the block is only there
+        // if the layer has shapes
+        uint32_t shapeCount = r.ReadU32();
+        if (shapeCount && shapeCount < 10)
+            r.Throw("Shape count out of range");
+        if (shapeCount > 10)
+        {
+            shapeCount -= 10;
+            r.CheckCount(shapeCount, Shape::MinSize);
+            for (uint32_t i = 0; i < shapeCount; i++)
+                Shape::Skim(r);
+            bool const extraData = r.ReadU32() == 2;
+            r.Skip(8);
+            // pads
+            if (uint32_t const count = r.ReadU32())
+            {
+                r.Skip(4);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    r.Skip(16); // net, dcode, pos
+                    bool const isExposed = r.ReadU8();
+                    bool const isCopper = r.ReadU8();
+                    uint8_t const testpointParam = r.ReadU8();
+                    if (!isCopper)
+                        continue;
+                    bool const isSomething = r.ReadU8();
+                    if (testpointParam == 1)
+                        r.Skip(12);
+                    if (isExposed || isSomething)
+                        r.Skip(16);
+                    bool const hasHole = r.ReadU8();
+                    r.Skip(1);
+                    if (hasHole)
+                        r.Skip(16);
+                }
+            }
+            auto const skimLines = [&r]()
+            {
+                if (uint32_t const count = r.ReadU32())
+                    r.Skip(4 + count*Line::RecordSize);
+            };
+            auto const skimArcs = [&r]()
+            {
+                if (uint32_t const count = r.ReadU32())
+                    r.Skip(4 + count*Arc::RecordSize);
+            };
+            skimLines();
+            skimArcs();
+            // surfaces
+            if (uint32_t const count = r.ReadU32())
+            {
+                r.Skip(4);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    r.Skip(4); // net
+                    r.Skip(size_t(r.ReadU32())*sizeof(Vector2S));
+                    r.Skip(4); // line width
+                    uint32_t const voidCount = r.ReadU32();
+                    if (!voidCount)
+                        continue;
+                    for (uint32_t vi = 0; vi < voidCount; vi++)
+                    {
+                        r.Skip(4); // tag
+                        r.Skip(size_t(r.ReadU32())*sizeof(Vector2S));
+                    }
+                    r.Skip(4); // void flags
+                }
+            }
+            if (extraData)
+            {
+                r.Skip(16);
+                skimLines();
+                skimArcs();
+                r.Skip(4);
+            }
+        }
+        // unknown items
+        uint32_t const unknownItemCount = r.ReadU32();
+        r.Skip(4);
+        if (unknownItemCount)
+        {
+            for (uint32_t i = 0; i < unknownItemCount; i++)
+                r.Skip(r.ReadU8() + UnknownItem::FixedSize);
+            r.Skip(4);
+        }
+        r.Skip(4);
+        // testpoints
+        r.Skip(r.ReadU32()*size_t(TestPoint::RecordSize) + 8);
+        r.Skip(r.ReadU32()*size_t(TestPoint2::RecordSize) + 4);
+        r.Skip(r.ReadU32()*size_t(TestPoint2::RecordSize) + 4);
+        uint32_t const testSequenceSize = r.ReadU32();
+        uint32_t const testSequenceParam = r.ReadU32();
+        r.Skip(testSequenceSize*size_t(TestNode::RecordSize));
+        if (testSequenceParam == 1)
+            r.Skip(12);
+    }
+
     void ThroughLayer::Tool::Load(StreamReader &r)
     {
         Flag1 = r.ReadBool8();
@@ -534,89 +638,168 @@ namespace Tebo
 
     void ThroughLayer::DrillHole::Load(StreamReader &r)
     {
-        Net = r.ReadS32();
-        Tool = r.ReadU32();
-        Pos = r.ReadVec2S();
+        // the record matches the struct layout
+        static_assert(sizeof(DrillHole) == RecordSize);
+        r.Read(this, 1);
     }
 
     void ThroughLayer::DrillSlot::Load(StreamReader &r)
     {
-        Net = r.ReadS32();
-        Tool = r.ReadU32();
-        Begin = r.ReadVec2S();
-        End = r.ReadVec2S();
-        Zero = r.ReadU32();
+        static_assert(sizeof(DrillSlot) == RecordSize);
+        r.Read(this, 1);
     }
 
     void ThroughLayer::Load(StreamReader &r)
     {
         Object::Load(r);
-        auto zero = r.ReadU32();
-        R_ASSERT(zero == 0);
-        zero = r.ReadU32();
-        R_ASSERT(zero == 0);
-        auto toolCount = r.ReadU32();
-        R_ASSERT(toolCount);
-        toolCount--;
-        Tools.reserve(toolCount);
-        for (uint32_t i = 0; i < toolCount; i++)
-            Tools.emplace_back().Load(r);
-        zero = r.ReadU8();
-        R_ASSERT(zero == 0);
+        r.ExpectU32(0);
+        r.ExpectU32(0);
+        {
+            StatScope stat(r, StatId::Tools);
+            auto toolCount = r.ReadU32();
+            if (!toolCount)
+                r.Throw("Tool count out of range");
+            toolCount--;
+            r.CheckCount(toolCount, Tool::RecordSize);
+            stat.Items = toolCount;
+            Tools.reserve(toolCount);
+            for (uint32_t i = 0; i < toolCount; i++)
+                Tools.emplace_back().Load(r);
+        }
+        if (r.ReadU8())
+            r.Throw("Unexpected constant value", r.Tell() - 1);
+        StatScope stat(r, StatId::Drills);
         auto const drillCount = r.ReadU32();
+        stat.Items = drillCount;
         {
-            auto v2 = r.ReadU32();
-            printf("- drill holes[%u], v2[%u]\n", drillCount, v2);
+            DrillParam = r.ReadU32();
+            printf("- name[%.*s] drill holes[%u], v2[%u]\n",
+                int(Name.size()), Name.data(), drillCount, DrillParam);
             // skip 4 zero dwords
-            uint32_t dummy[4];
-            r.Read(dummy, 4);
-            R_ASSERT(dummy[0] == 0);
-            R_ASSERT(dummy[1] == 0);
-            R_ASSERT(dummy[2] == 0);
-            R_ASSERT(dummy[3] == 0);
-        }
-        DrillHoles.reserve(drillCount);
-        // XXX: drill slot count must be stored somewhere
-        DrillSlots.reserve(100);
+            for (uint32_t i = 0; i < 4; i++)
+                r.ExpectU32(0);
+        }
+        { // holes and slots are mixed, count them before reserving
+            size_t const pos = r.Tell();
+            uint32_t holeCount = 0;
+            uint32_t slotCount = 0;
+            for (uint32_t i = 0; i < drillCount; i++)
+            {
+                switch (r.ReadU8())
+                {
+                case 0x08:
+                    holeCount++;
+                    r.Skip(DrillHole::RecordSize);
+                    continue;
+                case 0x0A:
+                case 0x0B:
+                    slotCount++;
+                    r.Skip(DrillSlot::RecordSize);
+                    continue;
+                default:
+                    r.Throw("Unrecognized drill code", r.Tell() - 1);
+                }
+            }
+            r.Seek(pos);
+            DrillHoles.reserve(holeCount);
+            DrillSlots.reserve(slotCount);
+            DrillCodes.reserve(drillCount);
+        }
+        for (uint32_t i = 0; i < drillCount; i++)
+        {
+            uint8_t const code = r.ReadU8();
+            DrillCodes.push_back(code);
+            switch (code)
+            {
+            case 0x08:
+            {
+                auto &hole = DrillHoles.emplace_back();
+                hole.Load(r);
+                if (!hole.Tool || hole.Tool > Tools.size())
+                    r.Throw("Drill tool index out of range");
+                continue;
+            }
+            case 0x0A:
+            case 0x0B:
+            {
+                auto &slot = DrillSlots.emplace_back();
+                slot.Load(r);
+                if (!slot.Tool || slot.Tool > Tools.size())
+                    r.Throw("Drill tool index out of range");
+                continue;
+            }
+            default:
+                r.Throw("Unrecognized drill code", r.Tell() - 1);
+            }
+        }
+    }
+
+    void ThroughLayer::Skim(StreamReader &r)
+    {
+        Object::Skim(r);
+        r.Skip(8);
+        uint32_t toolCount = r.ReadU32();
+        if (!toolCount)
+            r.Throw("Tool count out of range");
+        toolCount--;
+        r.CheckCount(toolCount, Tool::RecordSize);
+        r.Skip(toolCount*size_t(Tool::RecordSize) + 1);
+        uint32_t const drillCount = r.ReadU32();
+        r.Skip(4 + 16);
         for (uint32_t i = 0; i < drillCount; i++)
         {
             switch (r.ReadU8())
             {
             case 0x08:
-                DrillHoles.emplace_back().Load(r);
+                r.Skip(DrillHole::RecordSize);
                 continue;
             case 0x0A:
             case 0x0B:
-                DrillSlots.emplace_back().Load(r);
+                r.Skip(DrillSlot::RecordSize);
                 continue;
             default:
-                R_ASSERT(!"Unrecognized drill code");
+                r.Throw("Unrecognized drill code");
             }
         }
     }
 
     static std::unique_ptr<Object> LoadObject(StreamReader &r)
     {
-        Object *object = nullptr;
+        std::unique_ptr<Object> object;
+        size_t const pos = r.Tell();
         ObjectType const type = Object::Detect(r);
         switch (type)
         {
         case ObjectType::Logic:
-            object = new LogicLayer();
+            object = std::make_unique<LogicLayer>();
             break;
         case ObjectType::Through:
-            object = new ThroughLayer();
+            object = std::make_unique<ThroughLayer>();
             break;
         default:
-            R_ASSERT(!"Unrecognized ObjectType");
-            break;
+            r.Throw("Unrecognized object type");
         }
-        if (object)
+        object->Padding = uint32_t((r.Tell() - pos)/sizeof(uint32_t) - 1);
+        object->Load(r);
+        // layers may be loaded on several threads, so lines are tagged
+        printf("- name[%.*s] done at addr[0x%08X]\n",
+            int(object->Name.size()), object->Name.data(), uint32_t(r.Tell()));
+        return object;
+    }
+
+    static void SkimObject(StreamReader &r)
+    {
+        switch (Object::Detect(r))
         {
-            object->Load(r);
-            printf("- done at addr[0x%08X]\n", uint32_t(r.Tell()));
+        case ObjectType::Logic:
+            LogicLayer::Skim(r);
+            break;
+        case ObjectType::Through:
+            ThroughLayer::Skim(r);
+            break;
+        default:
+            r.Throw("Unrecognized object type");
         }
-        return std::unique_ptr<Object>(object);
     }
 
     void ProbeBox32::Load(StreamReader &r)
@@ -658,12 +841,13 @@ namespace Tebo
         P1 = r.ReadU32();
         r.Read(PX, 6);
         r.Read(Flags, 3);
-        uint32_t const itemCount = r.ReadU32();
-        R_ASSERT(itemCount > 0);
+        uint32_t const itemCount = r.ReadCount(ProbeDataItem::MinSize);
+        if (!itemCount)
+            r.Throw("Item count out of range");
         Items.reserve(itemCount);
         for (uint32_t i = 0; i < itemCount; i++)
             Items.emplace_back().Load(r);
-        uint32_t const boxCount = r.ReadU32();
+        uint32_t const boxCount = r.ReadCount(ProbeBox8::RecordSize);
         C1 = r.ReadU32();
         V1 = r.ReadVec2S();
         V2 = r.ReadVec2S();
@@ -672,37 +856,40 @@ namespace Tebo
             Boxes.emplace_back().Load(r);
     }
 
+    void FixtureData::Skim(StreamReader &r)
+    {
+        r.Skip(4 + 24 + 3);
+        uint32_t const itemCount = r.ReadU32();
+        for (uint32_t i = 0; i < itemCount; i++)
+        {
+            if (r.ReadU8()) // present
+                r.Skip(28);
+        }
+        uint32_t const boxCount = r.ReadU32();
+        r.Skip(4 + 16 + boxCount*size_t(17));
+    }
+
     void ProbeData::Load(StreamReader &r)
     {
         Fixture.Load(r);
         V3 = r.ReadVec2S();
         V4 = r.ReadVec2S();
-        uint32_t const box2Count = r.ReadU32();
+        uint32_t const box2Count = r.ReadCount(DoubleBox32::RecordSize);
         Boxes2.reserve(box2Count);
         for (uint32_t i = 0; i < box2Count; i++)
             Boxes2.emplace_back().Load(r);
     }
 
+    void ProbeData::Skim(StreamReader &r)
+    {
+        FixtureData::Skim(r);
+        r.Skip(16);
+        r.Skip(r.ReadU32()*size_t(44));
+    }
+
     void Probe::Load(StreamReader &r)
     {
-        Header.Flag = r.ReadBool8();
-        Header.Tag = r.ReadU32();
-        Header.Name = r.ReadString255();
-        Header.Size1 = r.ReadS32();
-        Header.Param1 = r.ReadU32();
-        Header.Size2 = r.ReadS32();
-        Header.Param2 = r.ReadU32();
-        Header.Size3 = r.ReadS32();
-        Header.Param3 = r.ReadU32();
-        Header.Color = r.ReadU32();
-        Header.K1 = r.ReadU32();
-        Header.V1 = r.ReadU32();
-        Header.K2 = r.ReadU32();
-        Header.V2 = r.ReadU32();
-        Header.K3 = r.ReadU32();
-        Header.V3 = r.ReadU32();
-        Header.K4 = r.ReadU32();
-        Header.V4 = r.ReadU32();
+        ProbeHeaderRecord::Read(r, Header);
         bool const hasBody = r.ReadBool8();
         if (hasBody)
         {
@@ -711,39 +898,30 @@ namespace Tebo
             Body = std::make_unique<ProbeData>();
             *Body = std::move(body);
         }
-        Tail.Tag = r.ReadU32();
-        Tail.Flag1 = r.ReadBool8();
-        Tail.Flag2 = r.ReadBool8();
-        Tail.Flag3 = r.ReadBool8();
-        Tail.P0 = r.ReadU8();
-        Tail.P1 = r.ReadS32();
-        Tail.P2 = r.ReadS32();
-        Tail.P3 = r.ReadS32();
-        Tail.B1.Tag = r.ReadS32();
-        Tail.B1.V1 = r.ReadVec2S();
-        Tail.B1.V2 = r.ReadVec2S();
-        Tail.B2.Tag = r.ReadS32();
-        Tail.B2.V1 = r.ReadVec2S();
-        Tail.B2.V2 = r.ReadVec2S();
+        ProbeTailRecord::Read(r, Tail);
+    }
+
+    void Probe::Skim(StreamReader &r)
+    {
+        r.Skip(1 + 4);
+        r.Skip(r.ReadU8() + size_t(60)); // name, sizes, params
+        if (r.ReadU8()) // has body
+            ProbeData::Skim(r);
+        r.Skip(60); // tail
     }
 
     void ProbeRegistry::Load(StreamReader &r)
     {
-        Z1 = r.ReadU32();
-        R_ASSERT(Z1 == 0);
-        Z2 = r.ReadU32();
-        R_ASSERT(Z2 == 0);
-        Param = r.ReadU32();
-        R_ASSERT(Param == 4);
-        Name = r.ReadString255();
-        DefaultSize = r.ReadU32();
-        uint32_t const packCount = r.ReadU32();
-        R_ASSERT(packCount > 0);
+        ProbeRegistryRecord::Read(r, *this);
+        uint32_t const packCount = r.ReadCount(sizeof(uint32_t));
+        if (!packCount)
+            r.Throw("Pack count out of range");
         Packs.reserve(packCount);
         for (uint32_t ip = 0; ip < packCount; ip++)
         {
             ProbePack pack;
-            uint32_t const probeCount = r.ReadU32();
+            uint32_t const probeCount = r.ReadCount(Probe::MinSize);
+            pack.reserve(probeCount);
             for (uint32_t i = 0; i < probeCount; i++)
             {
                 Probe p;
@@ -754,113 +932,140 @@ namespace Tebo
         }
     }
 
+    void ProbeRegistry::Skim(StreamReader &r)
+    {
+        r.Skip(12);
+        r.Skip(r.ReadU8() + size_t(4)); // name, default size
+        uint32_t const packCount = r.ReadU32();
+        for (uint32_t ip = 0; ip < packCount; ip++)
+        {
+            uint32_t const probeCount = r.ReadU32();
+            for (uint32_t i = 0; i < probeCount; i++)
+                Probe::Skim(r);
+        }
+    }
+
     void FixtureVariant::Load(StreamReader &r)
     {
-        Name = r.ReadString255();
-        ShortName = r.ReadString255();
+        Name = r.ReadStringView255();
+        ShortName = r.ReadStringView255();
         Flag1 = r.ReadBool8();
         Flag2 = r.ReadBool8();
         Data.Load(r);
     }
 
+    void FixtureVariant::Skim(StreamReader &r)
+    {
+        r.Skip(r.ReadU8());
+        r.Skip(r.ReadU8());
+        r.Skip(2);
+        FixtureData::Skim(r);
+    }
+
     void FixtureSetting::Load(StreamReader &r)
     {
-        Tag = r.ReadU32();
-        R_ASSERT(Tag == 3);
-        Name = r.ReadString255();
-        Param = r.ReadU32();
-        R_ASSERT(Param == 0);
-        uint32_t const variantCount = r.ReadU32();
+        Tag = r.ExpectU32(3);
+        Name = r.ReadStringView255();
+        Param = r.ExpectU32(0);
+        uint32_t const variantCount = r.ReadCount(FixtureVariant::MinSize);
         Variants.reserve(variantCount);
         for (uint32_t i = 0; i < variantCount; i++)
             Variants.emplace_back().Load(r);
         WorkspaceSize = r.ReadVec2S();
     }
 
+    void FixtureSetting::Skim(StreamReader &r)
+    {
+        r.Skip(4);
+        r.Skip(r.ReadU8() + size_t(4));
+        uint32_t const variantCount = r.ReadU32();
+        for (uint32_t i = 0; i < variantCount; i++)
+            FixtureVariant::Skim(r);
+        r.Skip(8);
+    }
+
     void FixtureRegistry::Load(StreamReader &r)
     {
-        Tag1 = r.ReadU32();
-        R_ASSERT(Tag1 == 0);
-        Tag2 = r.ReadU32();
-        R_ASSERT(Tag2 == 7874);
+        Tag1 = r.ExpectU32(0);
+        Tag2 = r.ExpectU32(7874);
         Grids.reserve(8);
         for (uint32_t i = 0; i < 8; i++)
-            Grids.push_back(r.ReadString255());
+            Grids.push_back(r.ReadStringView255());
         Top.Load(r);
         Bottom.Load(r);
     }
 
+    void FixtureRegistry::Skim(StreamReader &r)
+    {
+        r.Skip(8);
+        for (uint32_t i = 0; i < 8; i++)
+            r.Skip(r.ReadU8());
+        FixtureSetting::Skim(r);
+        FixtureSetting::Skim(r);
+    }
+
     void Pin::Load(StreamReader &r)
     {
         Handle = r.ReadU32();
-        Z1 = r.ReadU32();
-        R_ASSERT(Z1 == 0);
+        Z1 = r.ExpectU32(0);
         Id = r.ReadU32();
-        Name = r.ReadString255();
-        Z2 = r.ReadU32();
-        R_ASSERT(Z2 == 0);
+        Name = r.ReadStringView255();
+        Z2 = r.ExpectU32(0);
     }
 
     void Part::Load(StreamReader &r)
     {
-        Name = r.ReadString255();
-        Bbox.Min = r.ReadVec2S();
-        Bbox.Max = r.ReadVec2S();
-        Pos = r.ReadVec2S();
-        Angle = r.ReadS32();
-        Decal = r.ReadU32();
-        Type = PartType(r.ReadU32());
-        Z1 = r.ReadU32();
-        R_ASSERT(Z1 == 0);
-        Height = r.ReadS32();
-        Flag0 = r.ReadBool8();
-        Value = r.ReadString255();
-        ToleranceP = r.ReadString255();
-        ToleranceN = r.ReadString255();
-        Desc = r.ReadString255();
+        PartRecord::Read(r, *this);
         if (Flag0)
+            PartSerialRecord::Read(r, *this);
+        PartPinsRecord::Read(r, *this);
+        r.CheckCount(PinCount, Pin::MinSize);
+        Pins.reserve(PinCount);
+        for (uint32_t i = 0; i < PinCount; i++)
+            Pins.emplace_back().Load(r);
+    }
+
+    void Part::Skim(StreamReader &r)
+    {
+        r.Skip(r.ReadU8()); // name
+        r.Skip(PartPlacementRecord::Size - 1);
+        bool const hasSerial = r.ReadU8(); // Flag0
+        for (int i = 0; i < 4; i++) // value, tolerances, desc
+            r.Skip(r.ReadU8());
+        if (hasSerial)
         {
-            Serial = r.ReadString255();
-            Z2 = r.ReadU32();
-            R_ASSERT(Z2 == 0);
+            r.Skip(r.ReadU8());
+            r.Skip(4);
         }
-        auto const pinCount = r.ReadU32();
-        Layer = r.ReadU32();
-        P2 = r.ReadU32();
-        R_ASSERT(P2 == 0);
-        Pins.reserve(pinCount);
+        uint32_t const pinCount = r.ReadU32();
+        r.Skip(PartPinsRecord::Size - 4);
+        r.CheckCount(pinCount, Pin::MinSize);
         for (uint32_t i = 0; i < pinCount; i++)
-            Pins.emplace_back().Load(r);
+        {
+            r.Skip(12); // handle, zero, id
+            r.Skip(r.ReadU8()); // name
+            r.Skip(4);
+        }
     }
 
     void MysteriousBlock::Load(StreamReader &r)
+    { MysteriousBlockRecord::Read(r, *this); }
+
+    void MysteriousBlock::Skim(StreamReader &r)
+    { r.Skip(RecordSize); }
+
+    void Decal::Load(StreamReader &r)
     {
-        P1 = r.ReadU32();
-        P2 = r.ReadU32();
-        TopRight = r.ReadVec2S();
-        P3 = r.ReadU32();
-        P4 = r.ReadU32();
-        Flag1 = r.ReadBool8();
-        Flag2 = r.ReadBool8();
-        P5 = r.ReadU8();
-        P6 = r.ReadU8();
-        r.Read(P7x, 4);
-        r.Read(Flags, 6);
-        P8 = r.ReadU32();
-        P9 = r.ReadU32();
-        P10 = r.ReadU32();
-        P11 = r.ReadU32();
-        P12 = r.ReadU8();
-        P13 = r.ReadU8();
+        LoadHeader(r);
+        LoadLayers(r);
+        LoadOutline(r);
     }
 
-    void Decal::Load(StreamReader &r)
+    void Decal::LoadHeader(StreamReader &r)
+    { DecalHeaderRecord::Read(r, *this); }
+
+    void Decal::LoadLayers(StreamReader &r)
     {
-        Flag1 = r.ReadBool8();
-        R_ASSERT(Flag1);
-        Name = r.ReadString255();
-        r.Read(HeaderParams, 3);
-        Flag = r.ReadBool8();
         for (uint32_t i = 0; i < Layers.size(); i++)
         {
             bool const present = r.ReadBool8();
@@ -868,79 +1073,436 @@ namespace Tebo
                 continue;
             Layers[i] = LoadObject(r);
         }
-        OutlineFlag = r.ReadBool8();
-        R_ASSERT(OutlineFlag);
-        Param = r.ReadU32();
-        N1 = r.ReadS32();
-        OutlineVertexCount = r.ReadU32();
-        Outline.reserve(OutlineVertexCount);
-        for (uint32_t i = 0; i < OutlineVertexCount; i++)
+    }
+
+    void Decal::SkimLayers(StreamReader &r)
+    {
+        for (uint32_t i = 0; i < std::tuple_size_v<decltype(Layers)>; i++)
         {
-            Vector2S const v = r.ReadVec2S();
-            Outline.push_back(v);
+            if (r.ReadU8()) // present
+                SkimObject(r);
         }
+    }
+
+    void Decal::LoadOutline(StreamReader &r)
+    {
+        DecalOutlineRecord::Read(r, *this);
+        r.ReadArray(Outline, OutlineVertexCount);
         r.Read(Params, 2);
     }
 
+    static bool IsSkimmable(SectionType type)
+    {
+        switch (type)
+        {
+        case SectionType::Probes:
+        case SectionType::Fixtures:
+        case SectionType::Myb:
+        case SectionType::DecalLayers:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void Board::SkimSection(StreamReader &r, SectionType type)
+    {
+        StatScope stat(r, StatId::Skim);
+        stat.Items = 1;
+        switch (type)
+        {
+        case SectionType::Layer: SkimObject(r); break;
+        case SectionType::NetList:
+        {
+            uint32_t const netCount = r.ReadU32();
+            r.Skip(4);
+            for (uint32_t i = 0; i < netCount; i++)
+                r.Skip(r.ReadU8());
+            break;
+        }
+        case SectionType::Probes: ProbeRegistry::Skim(r); break;
+        case SectionType::Fixtures: FixtureRegistry::Skim(r); break;
+        case SectionType::Myb: MysteriousBlock::Skim(r); break;
+        case SectionType::Parts:
+        {
+            uint32_t const partCount = r.ReadU32();
+            r.Skip(4);
+            for (uint32_t i = 0; i < partCount; i++)
+                Part::Skim(r);
+            break;
+        }
+        case SectionType::Decal:
+        {
+            Decal decal;
+            decal.LoadHeader(r);
+            Decal::SkimLayers(r);
+            decal.LoadOutline(r);
+            break;
+        }
+        case SectionType::DecalLayers: Decal::SkimLayers(r); break;
+        default: R_ASSERT(!"Unrecognized section type");
+        }
+    }
+
+    SectionExtent Board::ReadSection(StreamReader &r, SectionType type, uint32_t index, bool skim)
+    {
+        SectionExtent section{type, index, {}};
+        section.Range.Offset = r.Tell();
+        bool const defer = skim && IsSkimmable(type);
+        if (defer)
+            SkimSection(r, type);
+        else
+            DecodeSection(r, type, index, skim);
+        section.Range.Size = r.Tell() - section.Range.Offset;
+        if (defer)
+            Deferred.push_back(section);
+        return section;
+    }
+
+    void Board::DecodeSection(StreamReader &r, SectionType type, uint32_t index, bool skim)
+    {
+        StatScope stat(r, LoadStats::SectionStat(type));
+        stat.Items = 1;
+        switch (type)
+        {
+        case SectionType::Layer:
+            R_ASSERT(index < Layers.size());
+            Layers[index] = LoadObject(r);
+            break;
+        case SectionType::NetList:
+            ReadNetList(r);
+            stat.Items = Nets.size();
+            break;
+        case SectionType::Probes:
+            Probes.Load(r);
+            break;
+        case SectionType::Fixtures:
+            Fixtures.Load(r);
+            break;
+        case SectionType::Myb:
+            Myb.Load(r);
+            break;
+        case SectionType::Parts:
+            ReadParts(r);
+            stat.Items = Parts.size();
+            break;
+        case SectionType::Decal:
+            ReadDecal(r, index, skim);
+            break;
+        case SectionType::DecalLayers:
+            R_ASSERT(index < Decals.size());
+            Decals[index].LoadLayers(r);
+            break;
+        default:
+            R_ASSERT(!"Unrecognized section type");
+        }
+    }
+
+    void Board::DecodeLayers(StreamSource &src, std::vector<SectionExtent> const &layers)
+    {
+        uint32_t const jobs = std::min(TaskPool::ResolveJobs(Jobs), uint32_t(layers.size()));
+        if (jobs > 1)
+            printf("- loading %zu layers with %u jobs\n", layers.size(), jobs);
+        // string pools aren't shared between threads
+        bool const copyStrings = GetStringPool(src) != nullptr;
+        std::vector<StringPool> layerStrings(copyStrings ? layers.size() : 0);
+        std::vector<LoadStats> layerStats(GetStats() ? layers.size() : 0);
+        TaskPool pool(jobs);
+        pool.ForEach(layers.size(), [&](size_t i)
+        {
+            auto const &layer = layers[i];
+            StreamReader lr(src, copyStrings ? &layerStrings[i] : nullptr);
+            if (!layerStats.empty())
+                lr.Stats = &layerStats[i];
+            lr.Seek(layer.Range.Offset);
+            DecodeSection(lr, SectionType::Layer, layer.Index, false);
+            if (lr.Tell() != layer.Range.Offset + layer.Range.Size)
+                lr.Throw("Layer size mismatch");
+        });
+        for (auto &ls : layerStrings)
+            strings.Merge(std::move(ls));
+        for (auto const &ls : layerStats)
+            Stats.Merge(ls);
+    }
+
+    void Board::ReadLayers(StreamReader &r, StreamSource &src)
+    {
+        r.CheckCount(Header.LayerCount, Object::MinSize);
+        Layers.resize(Header.LayerCount);
+        uint32_t const jobs = std::min(TaskPool::ResolveJobs(Jobs), Header.LayerCount);
+        if (jobs < 2 || !src.Persistent())
+        {
+            for (uint32_t li = 0; li < Header.LayerCount; li++)
+                Sections.push_back(ReadSection(r, SectionType::Layer, li, false));
+            return;
+        }
+        // layers are independent once their boundaries are known
+        std::vector<SectionExtent> layers;
+        layers.reserve(Header.LayerCount);
+        for (uint32_t li = 0; li < Header.LayerCount; li++)
+        {
+            SectionExtent layer{SectionType::Layer, li, {}};
+            layer.Range.Offset = r.Tell();
+            SkimSection(r, SectionType::Layer);
+            layer.Range.Size = r.Tell() - layer.Range.Offset;
+            layers.push_back(layer);
+        }
+        Sections.insert(Sections.end(), layers.begin(), layers.end());
+        DecodeLayers(src, layers);
+    }
+
     void Board::ReadNetList(StreamReader &r)
     {
-        uint32_t const netCount = r.ReadU32();
+        uint32_t const netCount = r.ReadCount(1);
         uint32_t const nc2 = r.ReadU32();
-        R_ASSERT(netCount > 0 && netCount == nc2);
+        if (!netCount || netCount != nc2)
+            r.Throw("Net count out of range");
         printf("- loading %u nets\n", netCount);
         Nets.reserve(netCount);
         for (uint32_t i = 0; i < netCount; i++)
-            Nets.push_back(r.ReadString255());
+            Nets.push_back(r.ReadStringView255());
     }
 
     void Board::ReadParts(StreamReader &r)
     {
-        uint32_t const partCount = r.ReadU32();
-        uint32_t const skip = r.ReadU32();
+        uint32_t const partCount = r.ReadCount(PartRecord::Size + PartPinsRecord::Size);
+        PartsParam = r.ReadU32();
         printf("- loading %u parts\n", partCount);
         Parts.reserve(partCount);
         for (uint32_t i = 0; i < partCount; i++)
             Parts.emplace_back().Load(r);
     }
 
-    void Board::ReadDecals(StreamReader &r)
+    void Board::ReadDecal(StreamReader &r, uint32_t index, bool skim)
     {
-        uint32_t const c = r.ReadU32();
-        R_ASSERT(c == 3);
-        uint32_t decalCount = r.ReadU32();
-        printf("- loading %u decals\n", decalCount);
-        Decals.reserve(decalCount);
-        for (uint32_t i = 0; i < decalCount; i++)
-            Decals.emplace_back().Load(r);
+        R_ASSERT(index < Decals.size());
+        auto &decal = Decals[index];
+        decal.LoadHeader(r);
+        ReadSection(r, SectionType::DecalLayers, index, skim);
+        decal.LoadOutline(r);
+    }
+
+    static char const *BackendToString(ReaderBackend backend)
+    {
+        switch (backend)
+        {
+        case ReaderBackend::Stream: return "stream";
+        case ReaderBackend::Buffered: return "buffered";
+        case ReaderBackend::Mapped: return "mapped";
+        case ReaderBackend::Push: return "push";
+        default: return "unknown";
+        }
+    }
+
+    static bool ParseSwitch(char const *value, bool &dst)
+    {
+        if (!std::strcmp(value, "on"))
+            dst = true;
+        else if (!std::strcmp(value, "off"))
+            dst = false;
+        else
+            return false;
+        return true;
+    }
+
+    bool Board::SetOption(char const *name, char const *value)
+    {
+        if (!std::strcmp(name, "reader"))
+        {
+            for (auto backend : {ReaderBackend::Stream, ReaderBackend::Buffered, ReaderBackend::Mapped,
+                ReaderBackend::Push})
+            {
+                if (!std::strcmp(value, BackendToString(backend)))
+                {
+                    Backend = backend;
+                    return true;
+                }
+            }
+            return false;
+        }
+        if (!std::strcmp(name, "skim"))
+            return ParseSwitch(value, Skim);
+        if (!std::strcmp(name, "jobs"))
+        {
+            char *end;
+            Jobs = uint32_t(std::strtoul(value, &end, 10));
+            return *value && !*end;
+        }
+        if (!std::strcmp(name, "index"))
+            return ParseSwitch(value, UseIndex);
+        if (!std::strcmp(name, "stats"))
+        {
+            StatsPath = value;
+            return !StatsPath.empty();
+        }
+        if (!std::strcmp(name, "strings"))
+        {
+            if (!std::strcmp(value, "view"))
+                ViewStrings = true;
+            else if (!std::strcmp(value, "copy"))
+                ViewStrings = false;
+            else
+                return false;
+            return true;
+        }
+        return false;
+    }
+
+    bool Board::ReadFile(char const *path)
+    {
+        if (UseIndex && OpenIndexed(path))
+        {
+            printf("- reading with section index\n");
+            LoadDeferred(Skim);
+            if (!StatsPath.empty() && !WriteStats(StatsPath.c_str()))
+                printf("! can't write load stats\n");
+            return true;
+        }
+        if (Backend != ReaderBackend::Mapped)
+        {
+            if (!BoardFormat::ReadFile(path))
+                return false;
+        }
+        else
+        {
+            auto src = std::make_shared<MemorySource>();
+            if (!src->Map(path))
+                return false;
+            printf("- reading with %s backend\n", BackendToString(Backend));
+            Read(src);
+        }
+        if (UseIndex && !WriteIndex(path))
+            printf("! can't write section index\n");
+        if (!StatsPath.empty() && !WriteStats(StatsPath.c_str()))
+            printf("! can't write load stats\n");
+        return true;
     }
 
     void Board::Read(std::istream &fs)
     {
-        StreamReader r(fs);
-        Header.Load(r);
-        Layers.reserve(Header.LayerCount);
-        for (uint32_t li = 0; li < Header.LayerCount; li++)
+        printf("- reading with %s backend\n", BackendToString(Backend));
+        switch (Backend)
+        {
+        case ReaderBackend::Stream:
+            Read(std::make_shared<DirectSource>(fs));
+            break;
+        case ReaderBackend::Buffered:
+            Read(std::make_shared<BufferedSource>(fs));
+            break;
+        case ReaderBackend::Push:
+        {
+            PushReader reader(*this);
+            std::vector<char> chunk(PushReader::ChunkSize);
+            while (fs.read(chunk.data(), chunk.size()), fs.gcount())
+                reader.Feed(chunk.data(), size_t(fs.gcount()));
+            reader.Finish();
+            break;
+        }
+        case ReaderBackend::Mapped:
+        default:
+        {
+            auto src = std::make_shared<MemorySource>();
+            src->Load(fs);
+            Read(src);
+            break;
+        }
+        }
+    }
+
+    void Board::Read(std::shared_ptr<StreamSource> const &src)
+    {
+        bool const skim = Skim && src->Persistent();
+        StreamReader r(*src, GetStringPool(*src));
+        r.Stats = GetStats();
+        sourceStrings = GetStringPool(*src) == nullptr;
         {
-            std::unique_ptr<Object> layer = LoadObject(r);
-            Layers.push_back(std::move(layer));
-        }
-        { // skip 4 zero dwords
-            uint32_t dummy[4];
-            r.Read(dummy, 4);
-            R_ASSERT(dummy[0] == 0);
-            R_ASSERT(dummy[1] == 0);
-            R_ASSERT(dummy[2] == 0);
-            R_ASSERT(dummy[3] == 0);
-        }
-        ReadNetList(r);
-        Probes.Load(r);
-        Fixtures.Load(r);
-        Myb.Load(r);
-        ReadParts(r);
-        ReadDecals(r);
+            StatScope stat(r, StatId::Header);
+            stat.Items = 1;
+            Header.Load(r);
+        }
+        ReadLayers(r, *src);
+        // skip 4 zero dwords
+        for (uint32_t i = 0; i < 4; i++)
+            r.ExpectU32(0);
+        for (auto type : {SectionType::NetList, SectionType::Probes, SectionType::Fixtures,
+            SectionType::Myb, SectionType::Parts})
+        {
+            Sections.push_back(ReadSection(r, type, 0, skim));
+        }
+        r.ExpectU32(3);
+        uint32_t const decalCount = r.ReadCount(Decal::MinSize);
+        printf("- loading %u decals\n", decalCount);
+        Decals.resize(decalCount);
+        for (uint32_t i = 0; i < decalCount; i++)
+            Sections.push_back(ReadSection(r, SectionType::Decal, i, skim));
         printf("- done reading at addr[0x%08X]\n", uint32_t(r.Tell()));
+        if (!Deferred.empty())
+            printf("- deferred %zu sections\n", Deferred.size());
+        source = src;
+        ReleaseSource();
     }
-    
+
+    bool Board::LoadSection(SectionType type, uint32_t index)
+    {
+        auto const pred = [&](SectionExtent const &s) { return s.Type==type && s.Index==index; };
+        auto const it = std::find_if(Deferred.begin(), Deferred.end(), pred);
+        if (it == Deferred.end())
+            return true;
+        R_ASSERT(source != nullptr);
+        // decoding a decal may defer its layers
+        auto const section = *it;
+        Deferred.erase(it);
+        StreamReader r(*source, GetStringPool(*source));
+        r.Stats = GetStats();
+        r.Seek(section.Range.Offset);
+        DecodeSection(r, type, index, Skim);
+        if (r.Tell() != section.Range.Offset + section.Range.Size)
+            r.Throw("Section size mismatch");
+        ReleaseSource();
+        return true;
+    }
+
+    void Board::LoadDeferred(bool skim)
+    {
+        if (Deferred.empty())
+            return;
+        R_ASSERT(source != nullptr);
+        std::vector<SectionExtent> pending;
+        pending.swap(Deferred);
+        std::vector<SectionExtent> layers;
+        for (auto const &section : pending)
+        {
+            if (section.Type == SectionType::Layer)
+                layers.push_back(section);
+        }
+        DecodeLayers(*source, layers);
+        StreamReader r(*source, GetStringPool(*source));
+        r.Stats = GetStats();
+        for (auto const &section : pending)
+        {
+            if (section.Type == SectionType::Layer)
+                continue;
+            if (skim && IsSkimmable(section.Type))
+            {
+                Deferred.push_back(section);
+                continue;
+            }
+            r.Seek(section.Range.Offset);
+            DecodeSection(r, section.Type, section.Index, skim);
+            if (r.Tell() != section.Range.Offset + section.Range.Size)
+                r.Throw("Section size mismatch");
+        }
+        if (!Deferred.empty())
+            printf("- deferred %zu sections\n", Deferred.size());
+        ReleaseSource();
+    }
+
+    void Board::ReleaseSource()
+    {
+        if (Deferred.empty() && !sourceStrings)
+            source.reset();
+    }
+
     static CBF::LayerType GetCbfType(LayerType t)
     {
         using Type = CBF::LayerType;
@@ -965,10 +1527,10 @@ namespace Tebo
         }
     }
 
-    void Board::ExportLayer(CBF::Board &cbf, ThroughLayer const *layer) const
+    std::unique_ptr<CBF::Layer> Board::ExportLayer(ThroughLayer const *layer) const
     {
         R_ASSERT(layer!=nullptr);
-        auto const cbfLayer = new CBF::DrillLayer();
+        auto cbfLayer = std::make_unique<CBF::DrillLayer>();
         cbfLayer->Name = layer->Name;
         cbfLayer->Type = GetCbfType(layer->Type);
         cbfLayer->PadColor = layer->PadColor;
@@ -992,43 +1554,192 @@ namespace Tebo
             cbfSlot.Width = layer->Tools[slot.Tool-1].Size;
             cbfLayer->Slots.push_back(std::move(cbfSlot));
         }
-        cbf.Layers.push_back(std::unique_ptr<CBF::Layer>(cbfLayer));
+        return cbfLayer;
+    }
+
+    static CBF::Scalar GetApertureWidth(Shape const &shape)
+    {
+        if (shape.Type == ShapeType::Round)
+            return shape.Size.X;
+        return std::min<CBF::Scalar>(shape.Size.X, shape.Size.Y);
+    }
+
+    static void ExportCopper(CBF::Geometry &copper, LogicLayer const *layer)
+    {
+        copper.Widths.reserve(layer->Shapes.size());
+        for (auto const &shape : layer->Shapes)
+            copper.Widths.push_back(GetApertureWidth(shape));
+        // D-codes were range checked when loading
+        copper.Lines.resize(layer->Lines.size());
+        for (size_t i = 0; i < layer->Lines.size(); i++)
+        {
+            auto const &line = layer->Lines[i];
+            auto &cbfLine = copper.Lines[i];
+            cbfLine.A = line.StartPos;
+            cbfLine.B = line.EndPos;
+            cbfLine.Net = line.Net;
+            cbfLine.Aperture = line.DCode - 10;
+        }
+        copper.Arcs.resize(layer->Arcs.size());
+        for (size_t i = 0; i < layer->Arcs.size(); i++)
+        {
+            auto const &arc = layer->Arcs[i];
+            auto &cbfArc = copper.Arcs[i];
+            cbfArc.Net = arc.Net;
+            cbfArc.Aperture = arc.DCode - 10;
+            cbfArc.Pos = arc.Pos;
+            cbfArc.Radius = arc.Radius;
+            cbfArc.StartAngle = arc.StartAngle;
+            cbfArc.SweepAngle = arc.SweepAngle;
+        }
+        size_t contourCount = 0, vertexCount = 0;
+        for (auto const &surface : layer->Surfaces)
+        {
+            contourCount += 1 + surface.Voids.size();
+            vertexCount += surface.Vertices.size();
+            for (auto const &cutout : surface.Voids)
+                vertexCount += cutout.Vertices.size();
+        }
+        copper.Surfaces.reserve(layer->Surfaces.size());
+        copper.ContourStart.reserve(copper.ContourStart.size() + contourCount);
+        copper.Vertices.reserve(vertexCount);
+        for (auto const &surface : layer->Surfaces)
+        {
+            copper.AddSurface(surface.Net, surface.LineWidth);
+            auto const &outline = surface.Vertices;
+            std::copy(outline.begin(), outline.end(), copper.AddContour(outline.size()));
+            for (auto const &cutout : surface.Voids)
+            {
+                auto const &vertices = cutout.Vertices;
+                std::copy(vertices.begin(), vertices.end(), copper.AddContour(vertices.size()));
+            }
+        }
+    }
+
+    static std::unique_ptr<CBF::Shape> ExportShape(Shape const &shape, ShapePool const &pool)
+    {
+        switch (shape.Type)
+        {
+        case ShapeType::Round:
+            return std::make_unique<CBF::Round>(shape.Size.X);
+        case ShapeType::Rect:
+            return std::make_unique<CBF::Rect>(shape.Size);
+        case ShapeType::RoundRect:
+            return std::make_unique<CBF::RoundRect>(shape.Size, shape.CornerRadius);
+        case ShapeType::Poly:
+        {
+            auto poly = std::make_unique<CBF::Poly>(CBF::Box2(shape.BBox.Min, shape.BBox.Max),
+                std::string(shape.Name));
+            auto const vertices = pool.Vertices.begin() + shape.FirstVertex;
+            poly->Vertices.assign(vertices, vertices + shape.VertexCount);
+            poly->Lines.reserve(shape.LineCount);
+            for (uint32_t i = 0; i < shape.LineCount; i++)
+            {
+                auto const &line = pool.Lines[shape.FirstLine + i];
+                auto &cbfLine = poly->Lines.emplace_back();
+                cbfLine.A = line.Start;
+                cbfLine.B = line.End;
+                cbfLine.Width = line.Width;
+            }
+            return poly;
+        }
+        default:
+            R_ASSERT(!"Unrecognized shape type");
+            return nullptr;
+        }
     }
 
-    void Board::ExportLayer(CBF::Board &cbf, LogicLayer const *layer) const
+    std::unique_ptr<CBF::Layer> Board::ExportLayer(LogicLayer const *layer) const
     {
         R_ASSERT(layer!=nullptr);
-        auto const cbfLayer = new CBF::LogicLayer();
+        auto cbfLayer = std::make_unique<CBF::LogicLayer>();
         cbfLayer->Name = layer->Name;
         cbfLayer->Type = GetCbfType(layer->Type);
         cbfLayer->PadColor = layer->PadColor;
         cbfLayer->LineColor = layer->LineColor;
         cbfLayer->Shapes.reserve(layer->Shapes.size());
-        { // XXX: support shapes
-            auto const cbfShape = new CBF::Round(8);
-            cbfLayer->Shapes.push_back(std::unique_ptr<CBF::Shape>(cbfShape));
-        }
+        for (auto const &shape : layer->Shapes)
+            cbfLayer->Shapes.push_back(ExportShape(shape, layer->ShapeData));
         cbfLayer->Pads.reserve(layer->Pads.size());
+        auto hole = layer->PadHoles.Data.begin();
         for (auto const &pad : layer->Pads)
         {
             CBF::Pad cbfPad;
             cbfPad.Net = pad.Net;
-            cbfPad.Shape = 0;
+            // D-codes were range checked when loading
+            cbfPad.Shape = pad.Shape;
             cbfPad.Pos = pad.Pos;
-            cbfPad.Turn = Angle::FromDegrees(0);
+            // rects are turned by their aperture, the rest have zero turn
+            cbfPad.Turn = Angle::FromDegrees(layer->Shapes[pad.Shape].Turn);
             cbfPad.HoleOffset = CBF::Vector2::Origin;
-            cbfPad.HoleSize = pad.HasHole ? pad.Hole.Size : CBF::Vector2::Origin;
+            // holes are in pad order
+            cbfPad.HoleSize = pad.HasHole ? (hole++)->Size : CBF::Vector2::Origin;
             cbfLayer->Pads.push_back(std::move(cbfPad));
         }
-        cbf.Layers.push_back(std::unique_ptr<CBF::Layer>(cbfLayer));
+        ExportCopper(cbfLayer->Copper, layer);
+        return cbfLayer;
+    }
+
+    std::unique_ptr<CBF::Layer> Board::ExportLayer(Object const *layer) const
+    {
+        switch (layer->ObjType)
+        {
+        case ObjectType::Through:
+            return ExportLayer(dynamic_cast<ThroughLayer const *>(layer));
+        case ObjectType::Logic:
+            return ExportLayer(dynamic_cast<LogicLayer const *>(layer));
+        default:
+            R_ASSERT(!"Unrecognized object type");
+            return nullptr;
+        }
+    }
+
+    static CBF::Part ExportPart(Part const &part)
+    {
+        CBF::Part cbfPart;
+        cbfPart.Name = part.Name;
+        cbfPart.Bbox = part.Bbox;
+        cbfPart.Turn = Angle::FromDegrees(float(part.Angle));
+        cbfPart.Decal = part.Decal;
+        cbfPart.Height = part.Height;
+        cbfPart.Value = part.Value;
+        cbfPart.ToleranceP = part.ToleranceP;
+        cbfPart.ToleranceN = part.ToleranceN;
+        cbfPart.Desc = part.Desc;
+        cbfPart.Layer = part.Layer;
+        cbfPart.Pins.reserve(part.Pins.size());
+        for (auto const &pin : part.Pins)
+        {
+            CBF::Pin cbfPin;
+            // XXX: detect multilayer pins
+            cbfPin.Layer = part.Layer;
+            cbfPin.Pad = pin.Handle/8;
+            cbfPin.Id = pin.Id;
+            cbfPin.Name = pin.Name;
+            cbfPart.Pins.push_back(std::move(cbfPin));
+        }
+        return cbfPart;
+    }
+
+    static CBF::Decal ExportDecal(Decal const &decal)
+    {
+        CBF::Decal cbfDecal;
+        cbfDecal.Name = decal.Name;
+        cbfDecal.Outline.reserve(decal.Outline.size());
+        for (auto const &v : decal.Outline)
+            cbfDecal.Outline.push_back(v);
+        return cbfDecal;
     }
 
-    void Board::Export(CBF::Board &cbf) const
+    // Shared by both Export flavors: a non-const board is consumed, each native
+    // layer, part and decal is released as soon as it has been converted
+    template <typename TBoard>
+    void Board::ExportBoard(TBoard &board, CBF::Board &cbf)
     {
         /* Tebo::Board
             TvwHeader Header;
             std::vector<std::unique_ptr<Object>> Layers;
-            std::vector<std::string> Nets;
+            std::vector<std::string_view> Nets;
             std::vector<Part> Parts;
             std::vector<Decal> Decals;
         */
@@ -1038,22 +1749,64 @@ namespace Tebo
             std::vector<Part> Parts;
             std::vector<Decal> Decals;
         */
-        cbf.Layers.reserve(Layers.size() + 1);
-        for (auto const &layer : Layers)
+        constexpr bool consume = !std::is_const_v<TBoard>;
+        // layers, parts and decals go to separate CBF members and are independent
+        size_t const layerCount = board.Layers.size();
+        // pins refer to pads by handle, which can only be checked once both
+        // parts and layers are loaded
+        for (auto const &part : board.Parts)
         {
-            switch (layer->ObjType)
+            if (part.Layer >= layerCount || board.Layers[part.Layer]->ObjType != ObjectType::Logic)
+                throw FormatError("Part layer out of range");
+            auto const layer = static_cast<LogicLayer const *>(board.Layers[part.Layer].get());
+            for (auto const &pin : part.Pins)
             {
-            case ObjectType::Through:
-                ExportLayer(cbf, dynamic_cast<ThroughLayer const *>(layer.get()));
-                break;
-            case ObjectType::Logic:
-                ExportLayer(cbf, dynamic_cast<LogicLayer const *>(layer.get()));
-                break;
-            default:
-                R_ASSERT(!"Unrecognized object type");
-                break;
+                if (pin.Handle/8 >= layer->Pads.size())
+                    throw FormatError("Pin handle out of range");
+            }
+        }
+        cbf.Layers.resize(layerCount);
+        TaskPool pool(uint32_t(std::min<size_t>(TaskPool::ResolveJobs(board.Jobs), layerCount + 2)));
+        pool.Run([&]()
+        {
+            cbf.Nets.assign(board.Nets.begin(), board.Nets.end());
+            cbf.Parts.reserve(board.Parts.size());
+            for (auto &part : board.Parts)
+            {
+                cbf.Parts.push_back(ExportPart(part));
+                if constexpr (consume)
+                    part = Part();
+            }
+            if constexpr (consume)
+            {
+                board.Nets = decltype(board.Nets)();
+                board.Parts = decltype(board.Parts)();
+            }
+        });
+        pool.Run([&]()
+        {
+            cbf.Decals.reserve(board.Decals.size());
+            for (auto &decal : board.Decals)
+            {
+                cbf.Decals.push_back(ExportDecal(decal));
+                if constexpr (consume)
+                    decal = Decal();
             }
+            if constexpr (consume)
+                board.Decals = decltype(board.Decals)();
+        });
+        for (size_t li = 0; li < layerCount; li++)
+        {
+            pool.Run([&, li]()
+            {
+                cbf.Layers[li] = board.ExportLayer(board.Layers[li].get());
+                if constexpr (consume)
+                    board.Layers[li].reset();
+            });
         }
+        pool.Wait();
+        if constexpr (consume)
+            board.Layers = decltype(board.Layers)();
         // add multilayer layer
         {
             auto const cbfLayer = new CBF::LogicLayer();
@@ -1063,44 +1816,20 @@ namespace Tebo
             cbfLayer->LineColor = 0xc0c0c0;
             cbf.Layers.push_back(std::unique_ptr<CBF::Layer>(cbfLayer));
         }
-        cbf.Nets = Nets;
-        cbf.Parts.reserve(Parts.size());
-        for (auto const &part : Parts)
-        {
-            CBF::Part cbfPart;
-            cbfPart.Name = part.Name;
-            cbfPart.Bbox = part.Bbox;
-            cbfPart.Turn = Angle::FromDegrees(float(part.Angle));
-            cbfPart.Decal = part.Decal;
-            cbfPart.Height = part.Height;
-            cbfPart.Value = part.Value;
-            cbfPart.ToleranceP = part.ToleranceP;
-            cbfPart.ToleranceN = part.ToleranceN;
-            cbfPart.Desc = part.Desc;
-            cbfPart.Layer = part.Layer;
-            cbfPart.Pins.reserve(part.Pins.size());
-            for (auto const &pin : part.Pins)
-            {
-                CBF::Pin cbfPin;
-                // XXX: detect multilayer pins
-                cbfPin.Layer = part.Layer;
-                cbfPin.Pad = pin.Handle/8;
-                cbfPin.Id = pin.Id;
-                cbfPin.Name = pin.Name;
-                cbfPart.Pins.push_back(std::move(cbfPin));
-            }
-            cbf.Parts.push_back(std::move(cbfPart));
-        }
-        cbf.Decals.reserve(Decals.size());
-        for (auto const &decal : Decals)
-        {
-            CBF::Decal cbfDecal;
-            cbfDecal.Name = decal.Name;
-            cbfDecal.Outline.reserve(decal.Outline.size());
-            for (auto const &v : decal.Outline)
-                cbfDecal.Outline.push_back(v);
-            cbf.Decals.push_back(std::move(cbfDecal));
-        }
+    }
+
+    void Board::Export(CBF::Board &cbf) const &
+    { ExportBoard(*this, cbf); }
+
+    void Board::Export(CBF::Board &cbf) &&
+    {
+        ExportBoard(*this, cbf);
+        // everything converted has been released, drop what the strings point to
+        Header = TvwHeader();
+        Sections = decltype(Sections)();
+        Deferred = decltype(Deferred)();
+        strings = StringPool();
+        source.reset();
     }
 
     static Board::Rep const Frep;
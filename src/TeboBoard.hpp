@@ -7,11 +7,22 @@
 #include "BoardFormat.hpp"
 #include "Fixed32.hpp"
 #include "StreamReader.hpp"
+#include "StreamSource.hpp"
+#include "StreamWriter.hpp"
+#include "StringPool.hpp"
+#include "TeboStats.hpp"
 #include "Box2.hpp"
+#include <algorithm> // std::lower_bound
 #include <istream> // std::istream
+#include <string_view>
 #include <vector>
 #include <array>
 
+namespace CBF
+{
+    class Layer;
+}
+
 namespace Tebo
 {
     struct Box2S
@@ -60,103 +71,109 @@ namespace Tebo
         Poly = 5,
     };
 
-    struct Shape
+    struct ShapeLine
     {
-        ShapeType Type;
-        Vector2S Size;
-        std::string Name;
-        float Turn; // degrees
+        int32_t Param1, Param2, Param3; // 1, 0, 0
+        Vector2S Start, End;
+        Fixed32 Width;
 
-        Shape(ShapeType shapeType, Vector2S shapeSize, float turn)
-        {
-            Type = shapeType;
-            Size = shapeSize;
-            Turn = turn;
-        }
-
-        virtual ~Shape() = 0;
+        static constexpr size_t RecordSize = 32;
 
-        static std::unique_ptr<Shape> Load(StreamReader &r);
+        void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
-    inline Shape::~Shape() = default;
-
-    struct Round : public Shape
+    // Poly outlines of all shapes of a layer
+    struct ShapePool
     {
-        Round(Vector2S shapeSize) :
-            Shape(ShapeType::Round, shapeSize, 0)
-        {}
+        std::vector<Vector2S> Vertices;
+        std::vector<ShapeLine> Lines;
     };
 
-    struct Rect : public Shape
-    {
-        Rect(Vector2S shapeSize, float turn) :
-            Shape(ShapeType::Rect, shapeSize, turn)
-        {}
-    };
-    
-    struct Poly : public Shape
+    // Aperture table entry, tagged by Type
+    struct Shape
     {
-        struct Line
-        {
-            int32_t Param1, Param2, Param3; // 1, 0, 0
-            Vector2S Start, End;
-            Fixed32 Width;
-
-            void Load(StreamReader &r);
-        };
-
-        Box2S BBox;
-        std::vector<Poly::Line> Lines;
+        ShapeType Type;
+        Vector2S Size;
+        float Turn = 0; // degrees; Rect, RoundRect
+        Fixed32 CornerRadius; // RoundRect
+        // Poly
+        std::string_view Name;
+        Box2S BBox = {};
         int32_t Flags[3] = {};
-        std::vector<Vector2S> Vertices;
+        // Unknown trailing values: two for Round, one for Rect and Poly
+        int32_t Params[2] = {};
+        // Position of the vertex list among the Poly subobjects, -1 if absent
+        int32_t VertexListIndex = -1;
+        uint32_t FirstVertex = 0, VertexCount = 0; // in ShapePool::Vertices
+        uint32_t FirstLine = 0, LineCount = 0; // in ShapePool::Lines
 
-        Poly(Vector2S shapeSize, std::string const &shapeName) :
-            Shape(ShapeType::Poly, shapeSize, 0)
-        {
-            Name = shapeName;
-        }
-    };
+        static constexpr size_t MinSize = 24;
 
-    struct RoundRect : public Shape
-    {
-    public:
-        Fixed32 CornerRadius;
-
-        RoundRect(Vector2S size, Fixed32 r, float turn) :
-            Shape(ShapeType::RoundRect, size, turn),
-            CornerRadius(r)
-        {}
+        void Load(StreamReader &r, ShapePool &pool);
+        void Save(StreamWriter &w, ShapePool const &pool) const;
+        static void Skim(StreamReader &r);
     };
-    
+
     struct Pad
     {
-        Tebo::Shape *Shape;
+        uint32_t Shape; // index in LogicLayer::Shapes
         int32_t Net;
         uint32_t DCode;
         Vector2S Pos;
         bool IsExposed;
         bool IsCopper;
         uint8_t TestpointParam; // 0 - smd pin, 1 - accessible, 2 - mask
-        // extensions
+        // extensions, data is in LogicLayer side tables
         bool IsSomething = false;
-        struct TestPointData
-        {
-            uint8_t Data12[12] = {};
-        } TestPoint;
-        struct ExposedData
-        {
-            Vector2S Min = {};
-            Vector2S Max = {};
-        } Exposed;
         bool HasHole = false;
         uint8_t TailParam = 0;
-        struct HoleData
+
+        static constexpr size_t MinSize = 19;
+    };
+
+    struct PadTestPoint
+    {
+        uint8_t Data12[12] = {};
+    };
+
+    // bbox of exposed area of the pad without rotation
+    struct PadExposed
+    {
+        Vector2S Min = {};
+        Vector2S Max = {};
+    };
+
+    struct PadHole
+    {
+        uint8_t Data7[7] = {};
+        Vector2S Size = {};
+        uint8_t Param = 0;
+    };
+
+    // Data present on a few pads only, sorted by pad index
+    template <typename T>
+    struct PadTable
+    {
+        std::vector<uint32_t> Pads;
+        std::vector<T> Data;
+
+        T &Add(uint32_t pad)
         {
-            uint8_t Data7[7] = {};
-            Vector2S Size = {};
-            uint8_t Param = 0;
-        } Hole;
+            R_ASSERT(Pads.empty() || Pads.back() < pad);
+            Pads.push_back(pad);
+            return Data.emplace_back();
+        }
+
+        T const *Find(uint32_t pad) const
+        {
+            auto const it = std::lower_bound(Pads.begin(), Pads.end(), pad);
+            if (it == Pads.end() || *it != pad)
+                return nullptr;
+            return &Data[it - Pads.begin()];
+        }
+
+        size_t Size() const { return Pads.size(); }
     };
 
     struct Primitive
@@ -177,6 +194,8 @@ namespace Tebo
     {
         Vector2S StartPos, EndPos;
 
+        static constexpr size_t RecordSize = 24;
+
         Line() : Primitive(PrimitiveType::Line)
         {}
     };
@@ -187,6 +206,8 @@ namespace Tebo
         Fixed32 Radius;
         float StartAngle, SweepAngle;
 
+        static constexpr size_t RecordSize = 28;
+
         Arc() : Primitive(PrimitiveType::Arc)
         {}
     };
@@ -196,6 +217,8 @@ namespace Tebo
         uint32_t Tag;
         uint32_t EdgeCount;
         std::vector<Vector2S> Vertices;
+
+        static constexpr size_t MinSize = 8;
     };
 
     struct Surface : public Primitive
@@ -207,6 +230,8 @@ namespace Tebo
         std::vector<Cutout> Voids;
         uint32_t VoidFlags = 0;
 
+        static constexpr size_t MinSize = 16;
+
         Surface() : Primitive(PrimitiveType::Surface)
         {
             DCode = 0;
@@ -215,11 +240,12 @@ namespace Tebo
 
     struct TvwHeader
     {
-        std::string Type;
+        // Type, Customer and Date are kept encoded, see Decode
+        std::string_view Type;
         uint32_t Const1; // = 1
-        std::string Customer;
+        std::string_view Customer;
         uint8_t Const2; // = 0
-        std::string Date;
+        std::string_view Date;
         uint8_t Const3[3]; // = {0, 0, 0}
         uint32_t Size1;
         uint32_t Size2;
@@ -227,6 +253,8 @@ namespace Tebo
         uint32_t LayerCount;
 
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static std::string Decode(std::string_view s);
     };
 
     enum class ObjectType : uint32_t
@@ -239,14 +267,17 @@ namespace Tebo
     struct Object
     {
         ObjectType ObjType; // 3 or 1
+        uint32_t Padding = 0; // zero dwords before ObjType
         uint32_t Magic[2]; // 2, 1
-        std::string Name;
-        std::string InitialName;
-        std::string InitialPath;
+        std::string_view Name;
+        std::string_view InitialName;
+        std::string_view InitialPath;
         LayerType Type;
         uint32_t PadColor;
         uint32_t LineColor;
 
+        static constexpr size_t MinSize = 27;
+
         static ObjectType Detect(StreamReader &r);
 
         Object(ObjectType objType)
@@ -258,6 +289,8 @@ namespace Tebo
         virtual ~Object() = default;
 
         virtual void Load(StreamReader &r);
+        virtual void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct TestPoint
@@ -271,7 +304,10 @@ namespace Tebo
         int32_t P5, P6;
         int32_t N;
 
+        static constexpr size_t RecordSize = 42;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct TestPoint2
@@ -285,7 +321,10 @@ namespace Tebo
         bool Flag4, Flag5, Flag6;
         int32_t N;
 
+        static constexpr size_t RecordSize = 54;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct TestNode
@@ -293,12 +332,15 @@ namespace Tebo
         uint32_t Current, Next;
         bool Flag;
 
+        static constexpr size_t RecordSize = 9;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct UnknownItem
     {
-        std::string Name;
+        std::string_view Name;
         Vector2S Pos;
         int32_t Z1;
         int32_t Param1, Param2, Param3;
@@ -306,16 +348,30 @@ namespace Tebo
         bool Flags[3];
         uint32_t Param4;
 
+        // excluding the name
+        static constexpr size_t FixedSize = 39;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct LogicLayer : public Object
     {
-        std::vector<std::unique_ptr<Shape>> Shapes;
+        std::vector<Shape> Shapes; // by dcode-10
+        ShapePool ShapeData;
         std::vector<Pad> Pads;
+        PadTable<PadTestPoint> PadTestPoints; // TestpointParam == 1
+        PadTable<PadExposed> PadExposedAreas; // IsExposed || IsSomething
+        PadTable<PadHole> PadHoles; // HasHole
         std::vector<Line> Lines;
         std::vector<Arc> Arcs;
         std::vector<Surface> Surfaces;
+        // 1 : normal; 2 : more lines and arcs follow the surfaces
+        uint32_t DataOrder = 1;
+        uint32_t ExtraParams[4] = {};
+        // lines and arcs from the extra data, at the end of Lines and Arcs
+        uint32_t ExtraLineCount = 0;
+        uint32_t ExtraArcCount = 0;
         uint32_t UnknownItemCount;
         uint32_t UnknownItemsParam;
         std::vector<UnknownItem> UnknownItems;
@@ -342,6 +398,14 @@ namespace Tebo
         void LoadUnknownItems(StreamReader &r);
         void LoadTestpoints(StreamReader &r);
         virtual void Load(StreamReader &r) override;
+        void SavePads(StreamWriter &w) const;
+        void SaveLines(StreamWriter &w, size_t first, size_t count) const;
+        void SaveArcs(StreamWriter &w, size_t first, size_t count) const;
+        void SaveSurfaces(StreamWriter &w) const;
+        void SaveUnknownItems(StreamWriter &w) const;
+        void SaveTestpoints(StreamWriter &w) const;
+        virtual void Save(StreamWriter &w) const override;
+        static void Skim(StreamReader &r);
     };
 
     struct ThroughLayer : public Object
@@ -353,7 +417,10 @@ namespace Tebo
             uint32_t Data5[5];
             uint8_t Data3[3]; // color?
 
+            static constexpr size_t RecordSize = 29;
+
             void Load(StreamReader &r);
+            void Save(StreamWriter &w) const;
         };
         std::vector<Tool> Tools;
         struct DrillHole
@@ -363,7 +430,10 @@ namespace Tebo
             uint32_t Tool; // 1-based index
             Vector2S Pos;
 
+            static constexpr size_t RecordSize = 16;
+
             void Load(StreamReader &r);
+            void Save(StreamWriter &w) const;
         };
         std::vector<DrillHole> DrillHoles;
         struct DrillSlot
@@ -374,14 +444,22 @@ namespace Tebo
             Vector2S Begin, End;
             uint32_t Zero; // = 0
 
+            static constexpr size_t RecordSize = 28;
+
             void Load(StreamReader &r);
+            void Save(StreamWriter &w) const;
         };
         std::vector<DrillSlot> DrillSlots;
+        uint32_t DrillParam = 0;
+        // Holes and slots in file order: 0x08 for a hole, 0x0A or 0x0B for a slot
+        std::vector<uint8_t> DrillCodes;
 
         ThroughLayer() : Object(ObjectType::Through)
         {}
     
         virtual void Load(StreamReader &r) override;
+        virtual void Save(StreamWriter &w) const override;
+        static void Skim(StreamReader &r);
     };
     
     struct ProbeBox32
@@ -390,6 +468,7 @@ namespace Tebo
         Vector2S V1, V2;
 
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct DoubleBox32
@@ -397,7 +476,10 @@ namespace Tebo
         uint32_t Tag;
         ProbeBox32 B1, B2;
 
+        static constexpr size_t RecordSize = 44;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct ProbeBox8
@@ -405,7 +487,10 @@ namespace Tebo
         int8_t Tag;
         int32_t N, A, P1, P2;
 
+        static constexpr size_t RecordSize = 17;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct ProbeDataItem
@@ -415,7 +500,10 @@ namespace Tebo
         uint32_t Params[5] = {};
         uint32_t Color = 0;
 
+        static constexpr size_t MinSize = 1;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     struct FixtureData
@@ -429,7 +517,11 @@ namespace Tebo
         Vector2S V1, V2;
         std::vector<ProbeBox8> Boxes;
 
+        static constexpr size_t MinSize = 59;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct ProbeData
@@ -439,15 +531,17 @@ namespace Tebo
         std::vector<DoubleBox32> Boxes2;
 
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct Probe
     {
-        struct
+        struct HeaderRecord
         {
             bool Flag; // 01
             uint32_t Tag; // 15
-            std::string Name; // "Spear_B_100 Mil"
+            std::string_view Name; // "Spear_B_100 Mil"
             Fixed32 Size1; // 7000
             uint32_t Param1; // 0x0012CCFC
             Fixed32 Size2; // 2000
@@ -461,16 +555,20 @@ namespace Tebo
             uint32_t K4, V4;
         } Header;
         std::unique_ptr<ProbeData> Body;
-        struct
+        struct TailRecord
         {
             uint32_t Tag;
             bool Flag1, Flag2, Flag3;
             uint8_t P0;
-            int32_t P1, P2, P3;        
+            int32_t P1, P2, P3;
             ProbeBox32 B1, B2;
         } Tail;
 
+        static constexpr size_t MinSize = 127;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     using ProbePack = std::vector<Probe>;
@@ -479,43 +577,53 @@ namespace Tebo
     {
         uint32_t Z1, Z2; // 0, 0
         uint32_t Param; // 4
-        std::string Name;
+        std::string_view Name;
         Fixed32 DefaultSize; // 118.11 mil = 3 mm
         std::vector<ProbePack> Packs;
 
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct FixtureVariant
     {
-        std::string Name;
-        std::string ShortName;
+        std::string_view Name;
+        std::string_view ShortName;
         bool Flag1; // = 1
         bool Flag2; // = 0
         FixtureData Data;
 
+        static constexpr size_t MinSize = 4 + FixtureData::MinSize;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct FixtureSetting
     {
         uint32_t Tag;
-        std::string Name;
+        std::string_view Name;
         uint32_t Param;
         std::vector<FixtureVariant> Variants;
         Vector2S WorkspaceSize;
 
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct FixtureRegistry
     {
         uint32_t Tag1; // must be 0
         uint32_t Tag2; // must be 7874
-        std::vector<std::string> Grids;
+        std::vector<std::string_view> Grids;
         FixtureSetting Top, Bottom;
 
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct Pin
@@ -523,10 +631,13 @@ namespace Tebo
         uint32_t Handle;
         uint32_t Z1;
         uint32_t Id;
-        std::string Name;
+        std::string_view Name;
         uint32_t Z2;
 
+        static constexpr size_t MinSize = 17;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
     };
 
     enum class PartType : uint32_t
@@ -558,7 +669,7 @@ namespace Tebo
 
     struct Part
     {
-        std::string Name;
+        std::string_view Name;
         Box2S Bbox;
         Vector2S Pos;
         int32_t Angle;
@@ -567,18 +678,20 @@ namespace Tebo
         uint32_t Z1;
         Fixed32 Height;
         bool Flag0;
-        std::string Value;
-        std::string ToleranceP;
-        std::string ToleranceN;
-        std::string Desc;
-        std::string Serial;
+        std::string_view Value;
+        std::string_view ToleranceP;
+        std::string_view ToleranceN;
+        std::string_view Desc;
+        std::string_view Serial;
         uint32_t Z2 = 0;
-        // uint32_t PinCount
+        uint32_t PinCount;
         uint32_t Layer; // 3 / 12
         uint32_t P2; // 0
         std::vector<Pin> Pins;
 
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct MysteriousBlock
@@ -594,13 +707,17 @@ namespace Tebo
         uint32_t P9, P10, P11;
         uint8_t P12, P13;
 
+        static constexpr size_t RecordSize = 68;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        static void Skim(StreamReader &r);
     };
 
     struct Decal
     {
         bool Flag1;
-        std::string Name;
+        std::string_view Name;
 
         uint32_t HeaderParams[3];
         bool Flag;
@@ -613,7 +730,41 @@ namespace Tebo
         std::vector<Vector2S> Outline;
         uint32_t Params[2]; // 0, 0
 
+        static constexpr size_t MinSize = 39;
+
         void Load(StreamReader &r);
+        void Save(StreamWriter &w) const;
+        void LoadHeader(StreamReader &r);
+        void LoadLayers(StreamReader &r);
+        void LoadOutline(StreamReader &r);
+        static void SkimLayers(StreamReader &r);
+    };
+
+    // Byte range in the source file
+    struct Extent
+    {
+        size_t Offset = 0;
+        size_t Size = 0;
+    };
+
+    enum class SectionType : uint32_t
+    {
+        Layer, // index: layer
+        NetList,
+        Probes,
+        Fixtures,
+        Myb,
+        Parts,
+        Decal, // index: decal
+        DecalLayers, // index: decal
+    };
+
+    // Section of the file that can be decoded on its own with Board::LoadSection
+    struct SectionExtent
+    {
+        SectionType Type;
+        uint32_t Index;
+        Extent Range;
     };
 
     class Board : public BoardFormat
@@ -621,17 +772,54 @@ namespace Tebo
     public:
         TvwHeader Header;
         std::vector<std::unique_ptr<Object>> Layers;
-        std::vector<std::string> Nets;
+        std::vector<std::string_view> Nets;
         ProbeRegistry Probes;
         FixtureRegistry Fixtures;
         MysteriousBlock Myb;
         std::vector<Part> Parts;
+        uint32_t PartsParam = 0;
         std::vector<Decal> Decals;
+        ReaderBackend Backend = ReaderBackend::Mapped;
+        // Skip probe, fixture and decal layer data while reading (needs a persistent source)
+        bool Skim = true;
+        // Layer decoding and export threads, 0 : one per hardware thread
+        uint32_t Jobs = 0;
+        // Read and write a section index next to the file (see IndexPath)
+        bool UseIndex = false;
+        // Keep strings as views into a persistent source instead of copying them to the string pool
+        bool ViewStrings = true;
+        // Top-level sections, in file order
+        std::vector<SectionExtent> Sections;
+        // Sections not decoded yet
+        std::vector<SectionExtent> Deferred;
+        // Write load stats as JSON to this path after reading, if set (see TeboStats.cpp)
+        std::string StatsPath;
+        LoadStats Stats;
 
     private:
+        // kept while there are deferred sections or strings pointing into it
+        std::shared_ptr<StreamSource> source;
+        bool sourceStrings = false;
+        // backs strings read from non-persistent sources
+        StringPool strings;
+
+        StringPool *GetStringPool(StreamSource const &src)
+        { return ViewStrings && src.Persistent() ? nullptr : &strings; }
+        LoadStats *GetStats()
+        { return StatsPath.empty() ? nullptr : &Stats; }
+        void ReleaseSource();
+        SectionExtent ReadSection(StreamReader &r, SectionType type, uint32_t index, bool skim);
+        void DecodeSection(StreamReader &r, SectionType type, uint32_t index, bool skim);
+        void DecodeLayers(StreamSource &src, std::vector<SectionExtent> const &layers);
+        void ReadLayers(StreamReader &r, StreamSource &src);
         void ReadNetList(StreamReader &r);
         void ReadParts(StreamReader &r);
-        void ReadDecals(StreamReader &r);
+        void ReadDecal(StreamReader &r, uint32_t index, bool skim);
+        bool LoadIndex(char const *path, StreamSource &src, std::vector<SectionExtent> &sections) const;
+        // Moves past a section without keeping its data
+        static void SkimSection(StreamReader &r, SectionType type);
+
+        friend class PushReader;
 
     public:
         class Rep : public BoardFormatRep
@@ -642,14 +830,44 @@ namespace Tebo
             virtual char const *Tag() const override { return "tebo"; }
             virtual char const *Desc() const override { return "Tebo-ICT view (*.TVW)"; }
             virtual bool CanRead() const override { return true; }
+            virtual char const *Options() const override
+            {
+                return "reader=stream|buffered|mapped|push  TVW reader backend (default: mapped)\n"
+                    "skim=on|off  defer probe, fixture and decal layer data (default: on, mapped reader only)\n"
+                    "jobs=N  layer decoding and export threads, 0 for one per core (default: 0)\n"
+                    "index=on|off  reuse or create a section index next to the input file (default: off)\n"
+                    "strings=view|copy  point strings into the mapped input or copy them (default: view)\n"
+                    "stats=<path>  write bytes, items and time per section and record type as JSON";
+            }
         };
 
+        virtual bool SetOption(char const *name, char const *value) override;
+        virtual bool ReadFile(char const *path) override;
         virtual void Read(std::istream &fs) override;
-        virtual void Export(CBF::Board &cbf) const override;
+        // Writes the board in the format Read accepts; all sections must be decoded
+        virtual void Write(std::ostream &fs) const override;
+        void Read(std::shared_ptr<StreamSource> const &src);
+        // Decodes a deferred section; true if the section is available
+        bool LoadSection(SectionType type, uint32_t index = 0);
+        // Decodes all deferred sections, except the ones skim mode would defer if skim is set
+        void LoadDeferred(bool skim);
+        // Maps the file and reads its header, deferring all other sections at the
+        // offsets stored in its index. False if there's no index or it's stale.
+        bool OpenIndexed(char const *path);
+        // Saves Sections to the index of the file they were read from
+        bool WriteIndex(char const *path) const;
+        static std::string IndexPath(char const *path);
+        // Saves Stats as JSON
+        bool WriteStats(char const *path) const;
+        virtual void Export(CBF::Board &cbf) const & override;
+        virtual void Export(CBF::Board &cbf) && override;
         virtual BoardFormatRep const &Frep() const override;
 
     private:
-        void ExportLayer(CBF::Board &cbf, ThroughLayer const *layer) const;
-        void ExportLayer(CBF::Board &cbf, LogicLayer const *layer) const;
+        std::unique_ptr<CBF::Layer> ExportLayer(Object const *layer) const;
+        std::unique_ptr<CBF::Layer> ExportLayer(ThroughLayer const *layer) const;
+        std::unique_ptr<CBF::Layer> ExportLayer(LogicLayer const *layer) const;
+        template <typename TBoard>
+        static void ExportBoard(TBoard &board, CBF::Board &cbf);
     };
 } // namespace Tebo
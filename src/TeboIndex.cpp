@@ -0,0 +1,130 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#include "TeboBoard.hpp"
+#include "FileMapping.hpp"
+#include "Hash.hpp"
+#include "TeboStats.hpp"
+#include <algorithm> // std::max
+#include <fstream>
+
+// Section index layout, little endian:
+//   u32 magic, u32 version
+//   u64 file size, u64 file hash
+//   u32 section count
+//   section count * {u32 type, u32 index, u64 offset, u64 size}
+// Sections are stored in file order, as listed in Board::Sections.
+
+namespace Tebo
+{
+    static uint32_t const IndexMagic = 0x49575654; // "TVWI"
+    static uint32_t const IndexVersion = 1;
+    static size_t const IndexHeaderSize = 28;
+    static size_t const IndexRecordSize = 24;
+
+    template <typename T>
+    static void WriteValue(std::ostream &os, T const &value)
+    { os.write(reinterpret_cast<char const *>(&value), sizeof(value)); }
+
+    std::string Board::IndexPath(char const *path)
+    { return std::string(path) + ".idx"; }
+
+    bool Board::WriteIndex(char const *path) const
+    {
+        FileMapping file;
+        if (!file.Open(path))
+            return false;
+        std::ofstream os(IndexPath(path), std::ios::binary);
+        if (!os)
+            return false;
+        WriteValue(os, IndexMagic);
+        WriteValue(os, IndexVersion);
+        WriteValue(os, uint64_t(file.Size()));
+        WriteValue(os, Hash64(file.Data(), file.Size()));
+        WriteValue(os, uint32_t(Sections.size()));
+        for (auto const &section : Sections)
+        {
+            WriteValue(os, uint32_t(section.Type));
+            WriteValue(os, section.Index);
+            WriteValue(os, uint64_t(section.Range.Offset));
+            WriteValue(os, uint64_t(section.Range.Size));
+        }
+        return bool(os);
+    }
+
+    bool Board::LoadIndex(char const *path, StreamSource &src,
+        std::vector<SectionExtent> &sections) const
+    {
+        std::ifstream is(path, std::ios::binary);
+        if (!is)
+            return false;
+        MemorySource index;
+        index.Load(is);
+        if (index.Size() < IndexHeaderSize)
+            return false;
+        StreamReader r(index);
+        if (r.ReadU32() != IndexMagic || r.ReadU32() != IndexVersion)
+            return false;
+        uint64_t fileSize, fileHash;
+        r.Read(&fileSize, 1);
+        r.Read(&fileHash, 1);
+        uint32_t const count = r.ReadU32();
+        if (index.Size() != IndexHeaderSize + size_t(count)*IndexRecordSize)
+            return false;
+        if (fileSize != src.Size())
+            return false;
+        auto const file = src.Fetch(0, src.Size());
+        if (fileHash != Hash64(file.Data, file.Size))
+            return false;
+        sections.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            SectionExtent section;
+            uint64_t offset, size;
+            section.Type = SectionType(r.ReadU32());
+            section.Index = r.ReadU32();
+            r.Read(&offset, 1);
+            r.Read(&size, 1);
+            if (section.Type > SectionType::Decal || section.Index >= count
+                || offset > fileSize || size > fileSize - offset)
+                return false;
+            section.Range = {size_t(offset), size_t(size)};
+            sections.push_back(section);
+        }
+        return true;
+    }
+
+    bool Board::OpenIndexed(char const *path)
+    {
+        auto src = std::make_shared<MemorySource>();
+        if (!src->Map(path))
+            return false;
+        std::vector<SectionExtent> sections;
+        if (!LoadIndex(IndexPath(path).c_str(), *src, sections))
+            return false;
+        uint32_t layerCount = 0, decalCount = 0;
+        for (auto const &section : sections)
+        {
+            if (section.Type == SectionType::Layer)
+                layerCount = std::max(layerCount, section.Index + 1);
+            else if (section.Type == SectionType::Decal)
+                decalCount = std::max(decalCount, section.Index + 1);
+        }
+        StreamReader r(*src, GetStringPool(*src));
+        r.Stats = GetStats();
+        sourceStrings = GetStringPool(*src) == nullptr;
+        {
+            StatScope stat(r, StatId::Header);
+            stat.Items = 1;
+            Header.Load(r);
+        }
+        if (layerCount != Header.LayerCount)
+            return false;
+        Layers.resize(layerCount);
+        Decals.resize(decalCount);
+        Sections = sections;
+        Deferred = std::move(sections);
+        source = std::move(src);
+        return true;
+    }
+} // namespace Tebo
@@ -0,0 +1,145 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#include "TeboPushReader.hpp"
+#include <algorithm> // std::max
+#include <utility> // std::exchange
+
+namespace Tebo
+{
+    PushReader::PushReader(Board &b) :
+        board(b),
+        task(Run())
+    {}
+
+    PushReader::~PushReader()
+    { task.Handle.destroy(); }
+
+    void PushReader::Feed(void const *data, size_t size)
+    {
+        if (Done())
+            return;
+        source.Append(data, size);
+        Resume();
+    }
+
+    void PushReader::Finish()
+    {
+        if (Done())
+            return;
+        source.Close();
+        Resume();
+        R_ASSERT(Done());
+    }
+
+    void PushReader::Resume()
+    {
+        if (Done() || !Ready())
+            return;
+        task.Handle.resume();
+        if (auto error = std::exchange(task.Handle.promise().Error, nullptr))
+            std::rethrow_exception(error);
+    }
+
+    template <typename Step>
+    bool PushReader::Attempt(Step &&step, bool commit)
+    {
+        StringPool strings;
+        LoadStats stats;
+        StreamReader r(source, &strings);
+        if (board.GetStats())
+            r.Stats = &stats;
+        r.Seek(pos);
+        try
+        {
+            step(r);
+        }
+        catch (InputPending const &)
+        {
+            // wait until the input grows by as much as this attempt got through,
+            // so every byte is read by a few attempts at most on average
+            size_t const size = source.Size();
+            required = size + std::max(size - pos, ChunkSize);
+            return false;
+        }
+        end = r.Tell();
+        // failed attempts aren't counted
+        if (r.Stats)
+            board.Stats.Merge(stats);
+        if (commit)
+        {
+            board.strings.Merge(std::move(strings));
+            pos = end;
+            source.Release(pos);
+        }
+        return true;
+    }
+
+    bool PushReader::ReadSection(SectionType type, uint32_t index)
+    {
+        // skim first, so that a section is decoded once it's complete
+        if (!Attempt([&](StreamReader &r) { Board::SkimSection(r, type); }, false))
+            return false;
+        size_t const start = pos, skimEnd = end;
+        bool const decoded = Attempt([&](StreamReader &r)
+            { board.DecodeSection(r, type, index, false); }, true);
+        // input that's skimmed and decoded differently is malformed
+        if (!decoded || end != skimEnd)
+            throw FormatError("Section size mismatch");
+        board.Sections.push_back({type, index, {start, end - start}});
+        return true;
+    }
+
+    PushReader::Task PushReader::Run()
+    {
+        // chunks are dropped once decoded, strings are copied
+        board.sourceStrings = false;
+        while (!Attempt([&](StreamReader &r)
+            {
+                StatScope stat(r, StatId::Header);
+                stat.Items = 1;
+                board.Header.Load(r);
+                r.CheckCount(board.Header.LayerCount, Object::MinSize);
+            }, true))
+        {
+            co_await MoreInput{*this};
+        }
+        board.Layers.resize(board.Header.LayerCount);
+        for (uint32_t li = 0; li < board.Header.LayerCount; li++)
+        {
+            while (!ReadSection(SectionType::Layer, li))
+                co_await MoreInput{*this};
+        }
+        while (!Attempt([](StreamReader &r)
+            { // skip 4 zero dwords
+                for (uint32_t i = 0; i < 4; i++)
+                    r.ExpectU32(0);
+            }, true))
+        {
+            co_await MoreInput{*this};
+        }
+        for (auto type : {SectionType::NetList, SectionType::Probes, SectionType::Fixtures,
+            SectionType::Myb, SectionType::Parts})
+        {
+            while (!ReadSection(type, 0))
+                co_await MoreInput{*this};
+        }
+        uint32_t decalCount = 0;
+        while (!Attempt([&](StreamReader &r)
+            {
+                r.ExpectU32(3);
+                decalCount = r.ReadCount(Decal::MinSize);
+            }, true))
+        {
+            co_await MoreInput{*this};
+        }
+        printf("- loading %u decals\n", decalCount);
+        board.Decals.resize(decalCount);
+        for (uint32_t i = 0; i < decalCount; i++)
+        {
+            while (!ReadSection(SectionType::Decal, i))
+                co_await MoreInput{*this};
+        }
+        printf("- done reading at addr[0x%08X]\n", uint32_t(pos));
+    }
+} // namespace Tebo
@@ -0,0 +1,87 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include "StreamSource.hpp"
+#include "TeboBoard.hpp"
+#include <coroutine>
+#include <exception> // std::exception_ptr
+
+namespace Tebo
+{
+    // Decodes a board from input handed over in chunks, e.g. from a pipe or a
+    // decompressor, so decoding overlaps with data arrival. The result is the
+    // same as Board::Read gives for the whole input, without deferred sections.
+    //
+    // Decoding runs in a coroutine that goes over the file section by section.
+    // A section is skimmed to find out whether all of it has arrived and only
+    // then decoded; when the input runs out, the coroutine suspends until Feed
+    // brings enough data for another attempt.
+    class PushReader
+    {
+    public:
+        static constexpr size_t ChunkSize = 1 << 16;
+
+        explicit PushReader(Board &board);
+        ~PushReader();
+
+        PushReader(PushReader const &) = delete;
+        PushReader &operator=(PushReader const &) = delete;
+
+        // Appends a chunk and decodes the sections it completes; throws
+        // FormatError on malformed input
+        void Feed(void const *data, size_t size);
+        // Ends the input and decodes the rest; throws FormatError if the board
+        // is incomplete
+        void Finish();
+        // True once the whole board is decoded, trailing input is ignored
+        bool Done() const { return task.Handle.done(); }
+
+    private:
+        struct Task
+        {
+            struct promise_type
+            {
+                std::exception_ptr Error;
+
+                Task get_return_object()
+                { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_always final_suspend() noexcept { return {}; }
+                void return_void() {}
+                void unhandled_exception() { Error = std::current_exception(); }
+            };
+
+            std::coroutine_handle<promise_type> Handle;
+        };
+
+        // Suspends Run until there's enough input for another attempt
+        struct MoreInput
+        {
+            PushReader const &Reader;
+
+            bool await_ready() const noexcept { return Reader.Ready(); }
+            void await_suspend(std::coroutine_handle<>) const noexcept {}
+            void await_resume() const noexcept {}
+        };
+
+        Board &board;
+        ChunkSource source;
+        // start of the next section
+        size_t pos = 0;
+        // where the last successful attempt stopped
+        size_t end = 0;
+        // input size worth another attempt
+        size_t required = 0;
+        Task task;
+
+        bool Ready() const { return !source.Pending() || source.Size() >= required; }
+        void Resume();
+        template <typename Step>
+        bool Attempt(Step &&step, bool commit);
+        bool ReadSection(SectionType type, uint32_t index);
+        Task Run();
+    };
+} // namespace Tebo
@@ -0,0 +1,169 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "TeboBoard.hpp"
+#include "RecordSchema.hpp"
+
+// TVW record layouts shared by the reader and the writer
+
+namespace Tebo
+{
+    using TestPointRecord = Record<
+        Field<&TestPoint::Flag1>,
+        Field<&TestPoint::P1>,
+        Field<&TestPoint::Handle>,
+        Field<&TestPoint::P2>,
+        Field<&TestPoint::P3>,
+        Field<&TestPoint::Pos>,
+        Field<&TestPoint::P4>,
+        Field<&TestPoint::Flag2>,
+        Field<&TestPoint::P5>,
+        Field<&TestPoint::P6>,
+        Field<&TestPoint::N>>;
+    static_assert(TestPointRecord::Size == TestPoint::RecordSize);
+
+    using TestPoint2Record = Record<
+        Field<&TestPoint2::P1>,
+        Field<&TestPoint2::Handle>,
+        Field<&TestPoint2::P2>,
+        Field<&TestPoint2::Pos>,
+        Field<&TestPoint2::Pos1>,
+        Field<&TestPoint2::Pos2>,
+        Field<&TestPoint2::Flag1>,
+        Field<&TestPoint2::Flag2>,
+        Field<&TestPoint2::Flag3>,
+        Field<&TestPoint2::Nail>,
+        Field<&TestPoint2::Param>,
+        Field<&TestPoint2::Flag4>,
+        Field<&TestPoint2::Flag5>,
+        Field<&TestPoint2::Flag6>,
+        Field<&TestPoint2::N>>;
+    static_assert(TestPoint2Record::Size == TestPoint2::RecordSize);
+
+    using TestNodeRecord = Record<
+        Field<&TestNode::Current>,
+        Field<&TestNode::Next>,
+        Field<&TestNode::Flag>>;
+    static_assert(TestNodeRecord::Size == TestNode::RecordSize);
+
+    using UnknownItemRecord = Record<
+        String255<&UnknownItem::Name>,
+        Record<
+            Field<&UnknownItem::Pos>,
+            Field<&UnknownItem::Z1>,
+            Field<&UnknownItem::Param1>,
+            Field<&UnknownItem::Param2>,
+            Field<&UnknownItem::Param3>,
+            Field<&UnknownItem::Z2>,
+            Field<&UnknownItem::Z3>,
+            Field<&UnknownItem::Flags>,
+            Field<&UnknownItem::Param4>>>;
+    static_assert(UnknownItemRecord::Size == 1 + UnknownItem::FixedSize);
+
+    using ProbeHeaderRecord = Record<
+        Record<
+            Field<&Probe::HeaderRecord::Flag>,
+            Field<&Probe::HeaderRecord::Tag>>,
+        String255<&Probe::HeaderRecord::Name>,
+        Record<
+            Field<&Probe::HeaderRecord::Size1>,
+            Field<&Probe::HeaderRecord::Param1>,
+            Field<&Probe::HeaderRecord::Size2>,
+            Field<&Probe::HeaderRecord::Param2>,
+            Field<&Probe::HeaderRecord::Size3>,
+            Field<&Probe::HeaderRecord::Param3>,
+            Field<&Probe::HeaderRecord::Color>,
+            Field<&Probe::HeaderRecord::K1>,
+            Field<&Probe::HeaderRecord::V1>,
+            Field<&Probe::HeaderRecord::K2>,
+            Field<&Probe::HeaderRecord::V2>,
+            Field<&Probe::HeaderRecord::K3>,
+            Field<&Probe::HeaderRecord::V3>,
+            Field<&Probe::HeaderRecord::K4>,
+            Field<&Probe::HeaderRecord::V4>>>;
+
+    using ProbeTailRecord = Record<
+        Field<&Probe::TailRecord::Tag>,
+        Field<&Probe::TailRecord::Flag1>,
+        Field<&Probe::TailRecord::Flag2>,
+        Field<&Probe::TailRecord::Flag3>,
+        Field<&Probe::TailRecord::P0>,
+        Field<&Probe::TailRecord::P1>,
+        Field<&Probe::TailRecord::P2>,
+        Field<&Probe::TailRecord::P3>,
+        Field<&Probe::TailRecord::B1>,
+        Field<&Probe::TailRecord::B2>>;
+    static_assert(ProbeTailRecord::Size == 60);
+
+    using ProbeRegistryRecord = Record<
+        Record<
+            Const<&ProbeRegistry::Z1, 0u>,
+            Const<&ProbeRegistry::Z2, 0u>,
+            Const<&ProbeRegistry::Param, 4u>>,
+        String255<&ProbeRegistry::Name>,
+        Field<&ProbeRegistry::DefaultSize>>;
+
+    // ends with Flag0, see Part::Skim
+    using PartPlacementRecord = Record<
+        Field<&Part::Bbox>,
+        Field<&Part::Pos>,
+        Field<&Part::Angle>,
+        Field<&Part::Decal>,
+        Field<&Part::Type>,
+        Const<&Part::Z1, 0u>,
+        Field<&Part::Height>,
+        Field<&Part::Flag0>>;
+
+    using PartRecord = Record<
+        String255<&Part::Name>,
+        PartPlacementRecord,
+        String255<&Part::Value>,
+        String255<&Part::ToleranceP>,
+        String255<&Part::ToleranceN>,
+        String255<&Part::Desc>>;
+
+    // present if Flag0 is set
+    using PartSerialRecord = Record<
+        String255<&Part::Serial>,
+        Const<&Part::Z2, 0u>>;
+
+    using PartPinsRecord = Record<
+        Field<&Part::PinCount>,
+        Field<&Part::Layer>,
+        Const<&Part::P2, 0u>>;
+
+    using MysteriousBlockRecord = Record<
+        Field<&MysteriousBlock::P1>,
+        Field<&MysteriousBlock::P2>,
+        Field<&MysteriousBlock::TopRight>,
+        Field<&MysteriousBlock::P3>,
+        Field<&MysteriousBlock::P4>,
+        Field<&MysteriousBlock::Flag1>,
+        Field<&MysteriousBlock::Flag2>,
+        Field<&MysteriousBlock::P5>,
+        Field<&MysteriousBlock::P6>,
+        Field<&MysteriousBlock::P7x>,
+        Field<&MysteriousBlock::Flags>,
+        Field<&MysteriousBlock::P8>,
+        Field<&MysteriousBlock::P9>,
+        Field<&MysteriousBlock::P10>,
+        Field<&MysteriousBlock::P11>,
+        Field<&MysteriousBlock::P12>,
+        Field<&MysteriousBlock::P13>>;
+    static_assert(MysteriousBlockRecord::Size == MysteriousBlock::RecordSize);
+
+    using DecalHeaderRecord = Record<
+        Const<&Decal::Flag1, true>,
+        String255<&Decal::Name>,
+        Record<
+            Field<&Decal::HeaderParams>,
+            Field<&Decal::Flag>>>;
+
+    using DecalOutlineRecord = Record<
+        Const<&Decal::OutlineFlag, true>,
+        Field<&Decal::Param>,
+        Field<&Decal::N1>,
+        Field<&Decal::OutlineVertexCount>>;
+} // namespace Tebo
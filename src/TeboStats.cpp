@@ -0,0 +1,78 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#include "TeboStats.hpp"
+#include "TeboBoard.hpp"
+#include <cinttypes> // PRIu64
+#include <cstdio> // std::snprintf
+#include <fstream>
+
+// Stats summary layout:
+//   {
+//     "<stat>": {"bytes": B, "items": N, "calls": C, "seconds": S},
+//     ...
+//   }
+// Stats that were never hit are left out. Seconds are summed over threads
+// decoding layers in parallel, so they can add up to more than the load took.
+
+namespace Tebo
+{
+    static_assert(LoadStats::SectionStat(SectionType::Layer) == StatId::Layer);
+    static_assert(LoadStats::SectionStat(SectionType::DecalLayers) == StatId::DecalLayers);
+
+    char const *LoadStats::Name(StatId id)
+    {
+        switch (id)
+        {
+        case StatId::Header: return "header";
+        case StatId::Layer: return "layer";
+        case StatId::NetList: return "netlist";
+        case StatId::Probes: return "probes";
+        case StatId::Fixtures: return "fixtures";
+        case StatId::Myb: return "myb";
+        case StatId::Parts: return "parts";
+        case StatId::Decal: return "decal";
+        case StatId::DecalLayers: return "decal_layers";
+        case StatId::Skim: return "skim";
+        case StatId::Shapes: return "shapes";
+        case StatId::Pads: return "pads";
+        case StatId::Lines: return "lines";
+        case StatId::Arcs: return "arcs";
+        case StatId::Surfaces: return "surfaces";
+        case StatId::UnknownItems: return "unknown_items";
+        case StatId::TestPoints: return "testpoints";
+        case StatId::Tools: return "tools";
+        case StatId::Drills: return "drills";
+        default: return "unknown";
+        }
+    }
+
+    void LoadStats::WriteJson(std::ostream &os) const
+    {
+        os << "{";
+        char const *sep = "\n";
+        for (size_t i = 0; i < Entries.size(); i++)
+        {
+            auto const &e = Entries[i];
+            if (!e.Calls)
+                continue;
+            char line[256];
+            std::snprintf(line, sizeof(line),
+                "  \"%s\": {\"bytes\": %" PRIu64 ", \"items\": %" PRIu64
+                ", \"calls\": %" PRIu64 ", \"seconds\": %.6f}",
+                Name(StatId(i)), e.Bytes, e.Items, e.Calls, e.Nanoseconds*1e-9);
+            os << sep << line;
+            sep = ",\n";
+        }
+        os << "\n}\n";
+    }
+
+    bool Board::WriteStats(char const *path) const
+    {
+        std::ofstream os(path);
+        if (!os)
+            return false;
+        Stats.WriteJson(os);
+        return bool(os);
+    }
+} // namespace Tebo
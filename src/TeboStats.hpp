@@ -0,0 +1,125 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include "StreamReader.hpp"
+#include <array>
+#include <chrono>
+#include <ostream>
+
+namespace Tebo
+{
+    enum class SectionType : uint32_t;
+
+    // What the reader spends input and time on. Section stats include the
+    // records decoded inside them.
+    enum class StatId : uint32_t
+    {
+        // top-level sections, in SectionType order
+        Header,
+        Layer,
+        NetList,
+        Probes,
+        Fixtures,
+        Myb,
+        Parts,
+        Decal,
+        DecalLayers,
+        // sections moved past to be decoded later
+        Skim,
+        // records in layers
+        Shapes,
+        Pads,
+        Lines,
+        Arcs,
+        Surfaces,
+        UnknownItems,
+        TestPoints,
+        Tools,
+        Drills,
+        Count
+    };
+
+    class LoadStats
+    {
+    public:
+        struct Entry
+        {
+            uint64_t Bytes = 0;
+            uint64_t Items = 0;
+            uint64_t Calls = 0;
+            uint64_t Nanoseconds = 0;
+        };
+
+        std::array<Entry, size_t(StatId::Count)> Entries;
+
+        static constexpr StatId SectionStat(SectionType type)
+        { return StatId(uint32_t(type) + 1); }
+
+        static char const *Name(StatId id);
+
+        void Add(StatId id, size_t bytes, size_t items, uint64_t ns)
+        {
+            auto &e = Entries[size_t(id)];
+            e.Bytes += bytes;
+            e.Items += items;
+            e.Calls++;
+            e.Nanoseconds += ns;
+        }
+
+        void Merge(LoadStats const &other)
+        {
+            for (size_t i = 0; i < Entries.size(); i++)
+            {
+                auto &e = Entries[i];
+                auto const &o = other.Entries[i];
+                e.Bytes += o.Bytes;
+                e.Items += o.Items;
+                e.Calls += o.Calls;
+                e.Nanoseconds += o.Nanoseconds;
+            }
+        }
+
+        // One object per stat that was hit, keyed by name
+        void WriteJson(std::ostream &os) const;
+    };
+
+    // Adds the input consumed and the time spent during its lifetime to a stat
+    // of the reader; does nothing if the reader doesn't collect stats
+    class StatScope
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        StreamReader &r;
+        StatId id;
+        size_t pos = 0;
+        Clock::time_point start;
+
+    public:
+        size_t Items = 0;
+
+        StatScope(StreamReader &reader, StatId stat) :
+            r(reader),
+            id(stat)
+        {
+            if (!r.Stats)
+                return;
+            pos = r.Tell();
+            start = Clock::now();
+        }
+
+        StatScope(StatScope const &) = delete;
+        StatScope &operator=(StatScope const &) = delete;
+
+        ~StatScope()
+        {
+            if (!r.Stats)
+                return;
+            auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+            r.Stats->Add(id, r.Tell() - pos, Items, uint64_t(ns.count()));
+        }
+    };
+} // namespace Tebo
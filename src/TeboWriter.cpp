@@ -0,0 +1,516 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#include "TeboBoard.hpp"
+#include "TeboRecords.hpp"
+
+// Serialization of a decoded board, mirroring the Load functions field by
+// field: a board read from a file is written back unchanged.
+
+namespace Tebo
+{
+    void ShapeLine::Save(StreamWriter &w) const
+    {
+        w.WriteS32(Param1);
+        w.WriteS32(Param2);
+        w.WriteS32(Param3);
+        w.WriteVec2S(Start);
+        w.WriteVec2S(End);
+        w.WriteS32(Width.ToRawInt());
+    }
+
+    void Shape::Save(StreamWriter &w, ShapePool const &pool) const
+    {
+        w.WriteU32(1);
+        w.WriteVec2S(Size);
+        w.WriteU32(uint32_t(Type));
+        switch (Type)
+        {
+        case ShapeType::Round:
+            w.Write(Params, 2);
+            break;
+        case ShapeType::Rect:
+            w.WriteFloat(Turn);
+            w.WriteS32(Params[0]);
+            break;
+        case ShapeType::Poly:
+        {
+            w.WriteS32(Params[0]);
+            w.WriteString255(Name);
+            w.WriteVec2S(BBox.Min);
+            w.WriteVec2S(BBox.Max);
+            uint32_t const subObjCount = LineCount + (VertexListIndex >= 0 ? 1 : 0);
+            w.WriteU32(subObjCount);
+            uint32_t line = FirstLine;
+            for (uint32_t i = 0; i < subObjCount; i++)
+            {
+                if (int32_t(i) == VertexListIndex)
+                {
+                    w.WriteU32(2); // poly
+                    w.Write(Flags, 3);
+                    w.WriteU32(VertexCount);
+                    w.Write(pool.Vertices.data() + FirstVertex, VertexCount);
+                    continue;
+                }
+                w.WriteU32(5); // line
+                pool.Lines[line++].Save(w);
+            }
+            break;
+        }
+        case ShapeType::RoundRect:
+            w.WriteFloat(Turn);
+            w.WriteS32(CornerRadius.ToRawInt());
+            break;
+        default:
+            R_ASSERT(!"Unrecognized shape type");
+            break;
+        }
+    }
+
+    void TvwHeader::Save(StreamWriter &w) const
+    {
+        w.WriteString255(Type);
+        w.WriteU32(Const1);
+        w.WriteString255(Customer);
+        w.WriteU8(Const2);
+        w.WriteString255(Date);
+        w.Write(Const3, 3);
+        w.WriteU32(Size1);
+        w.WriteU32(Size2);
+        w.WriteU32(Size3);
+        w.WriteU32(LayerCount);
+    }
+
+    void Object::Save(StreamWriter &w) const
+    {
+        w.Write(Magic, 2);
+        w.WriteString255(Name);
+        w.WriteString255(InitialName);
+        w.WriteString255(InitialPath);
+        w.WriteU32(uint32_t(Type));
+        w.WriteU32(PadColor);
+        w.WriteU32(LineColor);
+    }
+
+    void TestPoint::Save(StreamWriter &w) const
+    { TestPointRecord::Write(w, *this); }
+
+    void TestPoint2::Save(StreamWriter &w) const
+    { TestPoint2Record::Write(w, *this); }
+
+    void TestNode::Save(StreamWriter &w) const
+    { TestNodeRecord::Write(w, *this); }
+
+    void UnknownItem::Save(StreamWriter &w) const
+    { UnknownItemRecord::Write(w, *this); }
+
+    void LogicLayer::SavePads(StreamWriter &w) const
+    {
+        w.WriteU32(uint32_t(Pads.size()));
+        if (Pads.empty())
+            return;
+        w.WriteU32(2);
+        // side tables are in pad order
+        auto testPoint = PadTestPoints.Data.begin();
+        auto exposed = PadExposedAreas.Data.begin();
+        auto hole = PadHoles.Data.begin();
+        for (auto const &pad : Pads)
+        {
+            w.WriteS32(pad.Net);
+            w.WriteU32(pad.DCode);
+            w.WriteVec2S(pad.Pos);
+            w.WriteBool8(pad.IsExposed);
+            w.WriteBool8(pad.IsCopper);
+            w.WriteU8(pad.TestpointParam);
+            if (!pad.IsCopper)
+                continue;
+            w.WriteBool8(pad.IsSomething);
+            if (pad.TestpointParam == 1)
+                w.Write((testPoint++)->Data12, 12);
+            if (pad.IsExposed || pad.IsSomething)
+            {
+                w.WriteVec2S(exposed->Min);
+                w.WriteVec2S(exposed->Max);
+                exposed++;
+            }
+            w.WriteBool8(pad.HasHole);
+            w.WriteU8(pad.TailParam);
+            if (pad.HasHole)
+            {
+                w.Write(hole->Data7, 7);
+                w.WriteVec2S(hole->Size);
+                w.WriteU8(hole->Param);
+                hole++;
+            }
+        }
+        R_ASSERT(testPoint == PadTestPoints.Data.end());
+        R_ASSERT(exposed == PadExposedAreas.Data.end());
+        R_ASSERT(hole == PadHoles.Data.end());
+    }
+
+    void LogicLayer::SaveLines(StreamWriter &w, size_t first, size_t count) const
+    {
+        w.WriteU32(uint32_t(count));
+        if (!count)
+            return;
+        w.WriteU32(0);
+        for (size_t i = first; i < first + count; i++)
+        {
+            auto const &line = Lines[i];
+            w.WriteS32(line.Net);
+            w.WriteU32(line.DCode);
+            w.WriteVec2S(line.StartPos);
+            w.WriteVec2S(line.EndPos);
+        }
+    }
+
+    void LogicLayer::SaveArcs(StreamWriter &w, size_t first, size_t count) const
+    {
+        w.WriteU32(uint32_t(count));
+        if (!count)
+            return;
+        w.WriteU32(0);
+        for (size_t i = first; i < first + count; i++)
+        {
+            auto const &arc = Arcs[i];
+            w.WriteS32(arc.Net);
+            w.WriteU32(arc.DCode);
+            w.WriteVec2S(arc.Pos);
+            w.WriteS32(arc.Radius.ToRawInt());
+            w.WriteFloat(arc.StartAngle);
+            w.WriteFloat(arc.SweepAngle);
+        }
+    }
+
+    void LogicLayer::SaveSurfaces(StreamWriter &w) const
+    {
+        w.WriteU32(uint32_t(Surfaces.size()));
+        if (Surfaces.empty())
+            return;
+        w.WriteU32(2);
+        for (auto const &surface : Surfaces)
+        {
+            w.WriteS32(surface.Net);
+            w.WriteU32(uint32_t(surface.Vertices.size()));
+            w.WriteArray(surface.Vertices);
+            w.WriteS32(surface.LineWidth.ToRawInt());
+            w.WriteU32(uint32_t(surface.Voids.size()));
+            if (surface.Voids.empty())
+                continue;
+            for (auto const &cutout : surface.Voids)
+            {
+                w.WriteU32(cutout.Tag);
+                w.WriteU32(uint32_t(cutout.Vertices.size()));
+                w.WriteArray(cutout.Vertices);
+            }
+            w.WriteU32(surface.VoidFlags);
+        }
+    }
+
+    void LogicLayer::SaveUnknownItems(StreamWriter &w) const
+    {
+        w.WriteU32(uint32_t(UnknownItems.size()));
+        w.WriteU32(UnknownItemsParam);
+        if (!UnknownItems.empty())
+        {
+            for (auto const &item : UnknownItems)
+                item.Save(w);
+            w.WriteU32(0);
+        }
+        w.WriteU32(7);
+    }
+
+    void LogicLayer::SaveTestpoints(StreamWriter &w) const
+    {
+        w.WriteU32(uint32_t(TestPoints.size()));
+        for (auto const &tp : TestPoints)
+            tp.Save(w);
+        w.WriteU32(0);
+        w.WriteU32(4);
+        w.WriteU32(uint32_t(TestPoints2.size()));
+        w.WriteU32(TPS2Param);
+        for (auto const &tp : TestPoints2)
+            tp.Save(w);
+        w.WriteU32(uint32_t(TestPoints3.size()));
+        w.WriteU32(TPS3Param);
+        for (auto const &tp : TestPoints3)
+            tp.Save(w);
+        w.WriteU32(uint32_t(TestSequence.size()));
+        w.WriteU32(TestSequenceParam);
+        for (auto const &node : TestSequence)
+            node.Save(w);
+        if (TestSequenceParam == 1)
+        {
+            uint32_t const zero[3] = {};
+            w.Write(zero, 3);
+        }
+    }
+
+    void LogicLayer::Save(StreamWriter &w) const
+    {
+        Object::Save(w);
+        if (Shapes.empty())
+            w.WriteU32(0);
+        else
+        {
+            w.WriteU32(uint32_t(Shapes.size() + 10));
+            for (auto const &shape : Shapes)
+                shape.Save(w, ShapeData);
+            R_ASSERT(DataOrder == 1 || DataOrder == 2);
+            w.WriteU32(DataOrder);
+            w.WriteU32(0);
+            w.WriteU32(1);
+            SavePads(w);
+            bool const extraData = DataOrder == 2;
+            size_t const lineCount = Lines.size() - (extraData ? ExtraLineCount : 0);
+            size_t const arcCount = Arcs.size() - (extraData ? ExtraArcCount : 0);
+            SaveLines(w, 0, lineCount);
+            SaveArcs(w, 0, arcCount);
+            SaveSurfaces(w);
+            if (extraData)
+            {
+                w.Write(ExtraParams, 4);
+                SaveLines(w, lineCount, ExtraLineCount);
+                SaveArcs(w, arcCount, ExtraArcCount);
+                w.WriteU32(0);
+            }
+        }
+        SaveUnknownItems(w);
+        SaveTestpoints(w);
+    }
+
+    void ThroughLayer::Tool::Save(StreamWriter &w) const
+    {
+        w.WriteBool8(Flag1);
+        w.WriteBool8(Flag2);
+        w.WriteS32(Size.ToRawInt());
+        w.Write(Data5, 5);
+        w.Write(Data3, 3);
+    }
+
+    void ThroughLayer::DrillHole::Save(StreamWriter &w) const
+    { w.Write(this, 1); }
+
+    void ThroughLayer::DrillSlot::Save(StreamWriter &w) const
+    { w.Write(this, 1); }
+
+    void ThroughLayer::Save(StreamWriter &w) const
+    {
+        Object::Save(w);
+        w.WriteU32(0);
+        w.WriteU32(0);
+        w.WriteU32(uint32_t(Tools.size() + 1));
+        for (auto const &tool : Tools)
+            tool.Save(w);
+        w.WriteU8(0);
+        w.WriteU32(uint32_t(DrillCodes.size()));
+        w.WriteU32(DrillParam);
+        uint32_t const zero[4] = {};
+        w.Write(zero, 4);
+        auto hole = DrillHoles.begin();
+        auto slot = DrillSlots.begin();
+        for (uint8_t const code : DrillCodes)
+        {
+            w.WriteU8(code);
+            switch (code)
+            {
+            case 0x08:
+                (hole++)->Save(w);
+                continue;
+            case 0x0A:
+            case 0x0B:
+                (slot++)->Save(w);
+                continue;
+            default:
+                R_ASSERT(!"Unrecognized drill code");
+            }
+        }
+        R_ASSERT(hole == DrillHoles.end() && slot == DrillSlots.end());
+    }
+
+    static void SaveObject(StreamWriter &w, Object const &object)
+    {
+        for (uint32_t i = 0; i < object.Padding; i++)
+            w.WriteU32(0);
+        w.WriteU32(uint32_t(object.ObjType));
+        object.Save(w);
+    }
+
+    void ProbeBox32::Save(StreamWriter &w) const
+    {
+        w.WriteS32(Tag);
+        w.WriteVec2S(V1);
+        w.WriteVec2S(V2);
+    }
+
+    void DoubleBox32::Save(StreamWriter &w) const
+    {
+        w.WriteU32(Tag);
+        B1.Save(w);
+        B2.Save(w);
+    }
+
+    void ProbeBox8::Save(StreamWriter &w) const
+    {
+        w.WriteU8(uint8_t(Tag));
+        w.WriteS32(N);
+        w.WriteS32(A);
+        w.WriteS32(P1);
+        w.WriteS32(P2);
+    }
+
+    void ProbeDataItem::Save(StreamWriter &w) const
+    {
+        w.WriteBool8(Present);
+        if (Present)
+        {
+            w.WriteS32(Size.ToRawInt());
+            w.Write(Params, 5);
+            w.WriteU32(Color);
+        }
+    }
+
+    void FixtureData::Save(StreamWriter &w) const
+    {
+        w.WriteU32(P1);
+        w.Write(PX, 6);
+        w.Write(Flags, 3);
+        w.WriteU32(uint32_t(Items.size()));
+        for (auto const &item : Items)
+            item.Save(w);
+        w.WriteU32(uint32_t(Boxes.size()));
+        w.WriteU32(C1);
+        w.WriteVec2S(V1);
+        w.WriteVec2S(V2);
+        for (auto const &box : Boxes)
+            box.Save(w);
+    }
+
+    void ProbeData::Save(StreamWriter &w) const
+    {
+        Fixture.Save(w);
+        w.WriteVec2S(V3);
+        w.WriteVec2S(V4);
+        w.WriteU32(uint32_t(Boxes2.size()));
+        for (auto const &box : Boxes2)
+            box.Save(w);
+    }
+
+    void Probe::Save(StreamWriter &w) const
+    {
+        ProbeHeaderRecord::Write(w, Header);
+        w.WriteBool8(Body != nullptr);
+        if (Body)
+            Body->Save(w);
+        ProbeTailRecord::Write(w, Tail);
+    }
+
+    void ProbeRegistry::Save(StreamWriter &w) const
+    {
+        ProbeRegistryRecord::Write(w, *this);
+        w.WriteU32(uint32_t(Packs.size()));
+        for (auto const &pack : Packs)
+        {
+            w.WriteU32(uint32_t(pack.size()));
+            for (auto const &probe : pack)
+                probe.Save(w);
+        }
+    }
+
+    void FixtureVariant::Save(StreamWriter &w) const
+    {
+        w.WriteString255(Name);
+        w.WriteString255(ShortName);
+        w.WriteBool8(Flag1);
+        w.WriteBool8(Flag2);
+        Data.Save(w);
+    }
+
+    void FixtureSetting::Save(StreamWriter &w) const
+    {
+        w.WriteU32(Tag);
+        w.WriteString255(Name);
+        w.WriteU32(Param);
+        w.WriteU32(uint32_t(Variants.size()));
+        for (auto const &variant : Variants)
+            variant.Save(w);
+        w.WriteVec2S(WorkspaceSize);
+    }
+
+    void FixtureRegistry::Save(StreamWriter &w) const
+    {
+        w.WriteU32(Tag1);
+        w.WriteU32(Tag2);
+        R_ASSERT(Grids.size() == 8);
+        for (auto const &grid : Grids)
+            w.WriteString255(grid);
+        Top.Save(w);
+        Bottom.Save(w);
+    }
+
+    void Pin::Save(StreamWriter &w) const
+    {
+        w.WriteU32(Handle);
+        w.WriteU32(Z1);
+        w.WriteU32(Id);
+        w.WriteString255(Name);
+        w.WriteU32(Z2);
+    }
+
+    void Part::Save(StreamWriter &w) const
+    {
+        PartRecord::Write(w, *this);
+        if (Flag0)
+            PartSerialRecord::Write(w, *this);
+        R_ASSERT(PinCount == Pins.size());
+        PartPinsRecord::Write(w, *this);
+        for (auto const &pin : Pins)
+            pin.Save(w);
+    }
+
+    void MysteriousBlock::Save(StreamWriter &w) const
+    { MysteriousBlockRecord::Write(w, *this); }
+
+    void Decal::Save(StreamWriter &w) const
+    {
+        DecalHeaderRecord::Write(w, *this);
+        for (auto const &layer : Layers)
+        {
+            w.WriteBool8(layer != nullptr);
+            if (layer)
+                SaveObject(w, *layer);
+        }
+        R_ASSERT(OutlineVertexCount == Outline.size());
+        DecalOutlineRecord::Write(w, *this);
+        w.WriteArray(Outline);
+        w.Write(Params, 2);
+    }
+
+    void Board::Write(std::ostream &fs) const
+    {
+        R_ASSERT(Deferred.empty());
+        R_ASSERT(Header.LayerCount == Layers.size());
+        StreamWriter w(fs);
+        Header.Save(w);
+        for (auto const &layer : Layers)
+            SaveObject(w, *layer);
+        uint32_t const zero[4] = {};
+        w.Write(zero, 4);
+        // net list
+        w.WriteU32(uint32_t(Nets.size()));
+        w.WriteU32(uint32_t(Nets.size()));
+        for (auto const &net : Nets)
+            w.WriteString255(net);
+        Probes.Save(w);
+        Fixtures.Save(w);
+        Myb.Save(w);
+        w.WriteU32(uint32_t(Parts.size()));
+        w.WriteU32(PartsParam);
+        for (auto const &part : Parts)
+            part.Save(w);
+        w.WriteU32(3);
+        w.WriteU32(uint32_t(Decals.size()));
+        for (auto const &decal : Decals)
+            decal.Save(w);
+    }
+} // namespace Tebo
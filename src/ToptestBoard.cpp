@@ -232,7 +232,10 @@ namespace Toptest
             return nullptr;
         };
         parts.reserve(src.Parts.size());
-        pins.reserve(top->Pads.size() + bottom->Pads.size());
+        size_t pinCount = 0;
+        for (CBF::Part const &part : src.Parts)
+            pinCount += part.PinCount();
+        pins.reserve(pinCount);
         for (CBF::Part const &part : src.Parts)
         {
             if (part.Layer != topIndex && part.Layer != bottomIndex)
@@ -241,7 +244,7 @@ namespace Toptest
             dstPart->Name(part.Name);
             dstPart->Layer(GetLayerCode(src, part.Layer));
             dstPart->FirstPin(pins.size());
-            dstPart->PinCount(part.Pins.size());
+            dstPart->PinCount(part.PinCount());
             auto const verts = {
                 part.Bbox.Min,
                 {part.Bbox.Min.X, part.Bbox.Max.Y},
@@ -254,19 +257,16 @@ namespace Toptest
             dstPart->BBox(bbox);
             // note 1: assuming pins are sorted by id in ascending order
             // note 2: in Tebo board parts can not have pins on multiple layers
-            for (CBF::Pin const &pin : part.Pins)
+            src.ForEachPin(part, [&](CBF::PinInstance const &pin)
             {
                 auto dstPin = std::make_unique<Pin>();
-                dstPin->Name(pin.Name);
+                dstPin->Name(std::string(pin.Name));
                 dstPin->Layer(GetLayerCode(src, pin.Layer));
-                auto const srcLayer = getLayerByIndex(pin.Layer);
-                R_ASSERT(srcLayer && "Only multilayer, top and bottom layers are allowed for pins");
-                R_ASSERT(pin.Pad < srcLayer->Pads.size());
-                auto const &pad = srcLayer->Pads[pin.Pad];
-                dstPin->Location(pad.Pos);
-                dstPin->Net(pad.Net+1);
+                R_ASSERT(getLayerByIndex(pin.Layer) && "Only multilayer, top and bottom layers are allowed for pins");
+                dstPin->Location(pin.Pad.Pos);
+                dstPin->Net(pin.Pad.Net+1);
                 pins.push_back(std::move(dstPin));
-            }
+            });
             parts.push_back(std::move(dstPart));
         }
     }
@@ -0,0 +1,481 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#include "XMLReader.hpp"
+#include <algorithm> // std::count
+#include <charconv> // std::from_chars
+#include <cstdio> // std::snprintf
+#include <cstdlib> // std::abs
+#include <cstring> // std::memchr, std::memcmp
+
+namespace XML
+{
+    std::string_view Element::String(std::string_view key) const
+    {
+        auto const attr = Find(key);
+        if (!attr)
+            throw Error("Attribute not found: " + std::string(key));
+        return attr->Value;
+    }
+
+    int32_t Element::Int32(std::string_view key) const
+    {
+        auto const attr = Find(key);
+        if (!attr)
+            throw Error("Attribute not found: " + std::string(key));
+        return ToInt32(*attr);
+    }
+
+    double Element::Double(std::string_view key) const
+    {
+        auto const attr = Find(key);
+        if (!attr)
+            throw Error("Attribute not found: " + std::string(key));
+        return ToDouble(*attr);
+    }
+
+    // Powers of ten that are exact in a double
+    static constexpr double Pow10[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    std::from_chars_result FixedDecimal::FromChars(char const *first, char const *last, FixedDecimal &value)
+    {
+        // any 18 digits fit in int64_t
+        constexpr uint32_t maxDigits = 18;
+        char const *p = first;
+        bool const negative = p != last && *p == '-';
+        if (negative)
+            p++;
+        int64_t mantissa = 0;
+        uint32_t digits = 0; // from the first nonzero one
+        uint32_t scale = 0;
+        bool point = false, any = false, overflow = false;
+        auto const push = [&](uint32_t digit)
+        {
+            if (digits == maxDigits)
+                overflow = true;
+            else
+            {
+                mantissa = mantissa*10 + digit;
+                digits += mantissa != 0;
+            }
+            scale += point;
+        };
+        // trailing fractional zeros are only pushed if a nonzero digit follows
+        uint32_t zeros = 0;
+        for (; p != last; p++)
+        {
+            if (*p == '.' && !point)
+            {
+                point = true;
+                continue;
+            }
+            if (*p < '0' || *p > '9')
+                break;
+            any = true;
+            uint32_t const digit = uint32_t(*p - '0');
+            if (point && !digit)
+            {
+                zeros++;
+                continue;
+            }
+            for (; zeros; zeros--)
+                push(0);
+            push(digit);
+        }
+        if (!any || (p != last && (*p == 'e' || *p == 'E')))
+            return {first, std::errc::invalid_argument};
+        if (overflow || scale > maxDigits)
+            return {p, std::errc::result_out_of_range};
+        value.Mantissa = negative ? -mantissa : mantissa;
+        value.Scale = scale;
+        return {p, std::errc()};
+    }
+
+    double FixedDecimal::ToDouble() const
+    {
+        // a single rounding as long as the mantissa fits in 53 bits
+        return double(Mantissa)/Pow10[Scale];
+    }
+
+    double FixedDecimal::Scaled(int64_t factor, uint32_t factorScale) const
+    {
+        // the product is exact in a double if it fits in 53 bits, then only
+        // the division rounds
+        constexpr int64_t exact = int64_t(1) << 53;
+        if (factor && std::abs(Mantissa) <= exact/std::abs(factor) && Scale + factorScale < std::size(Pow10))
+            return double(Mantissa*factor)/Pow10[Scale + factorScale];
+        return ToDouble()*(double(factor)/Pow10[factorScale]);
+    }
+
+    // from_chars and FixedDecimal don't depend on the locale, unlike strtod
+    // and strtol. Anything after the number is ignored, as tinyxml2 used to.
+    int32_t Element::ToInt32(Attribute const &attr)
+    {
+        auto const &value = attr.Value;
+        int32_t v;
+        if (std::from_chars(value.data(), value.data() + value.size(), v).ec != std::errc())
+            throw Error("Can't parse attribute: " + std::string(attr.Name));
+        return v;
+    }
+
+    FixedDecimal Element::ToDecimal(Attribute const &attr)
+    {
+        auto const &value = attr.Value;
+        FixedDecimal v;
+        if (FixedDecimal::FromChars(value.data(), value.data() + value.size(), v).ec != std::errc())
+            throw Error("Can't parse attribute: " + std::string(attr.Name));
+        return v;
+    }
+
+    double Element::ToDouble(Attribute const &attr)
+    { return ToDecimal(attr).ToDouble(); }
+
+    Reader::Reader(char const *data, size_t size) :
+        Reader(data, size, data)
+    {}
+
+    Reader::Reader(char const *data, size_t size, char const *origin) :
+        origin(origin),
+        cur(data),
+        end(data + size)
+    {}
+
+    void Reader::Throw(char const *what) const
+    {
+        size_t const line = 1 + std::count(origin, std::min(cur, end), '\n');
+        char msg[128];
+        std::snprintf(msg, sizeof(msg), "%s at line %zu", what, line);
+        throw Error(msg);
+    }
+
+    static bool IsSpace(char c)
+    { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    void Reader::SkipSpace()
+    {
+        while (cur != end && IsSpace(*cur))
+            cur++;
+    }
+
+    void Reader::SkipPast(std::string_view terminator)
+    {
+        auto const it = std::search(cur, end, terminator.begin(), terminator.end());
+        if (it == end)
+            Throw("Unterminated markup");
+        cur = it + terminator.size();
+    }
+
+    void Reader::SkipDoctype()
+    {
+        // the internal subset in brackets may contain '>'
+        int depth = 0;
+        for (; cur != end; cur++)
+        {
+            if (*cur == '[')
+                depth++;
+            else if (*cur == ']')
+                depth--;
+            else if (*cur == '>' && !depth)
+            {
+                cur++;
+                return;
+            }
+        }
+        Throw("Unterminated doctype");
+    }
+
+    // cur is past '<' at '?' or '!'
+    void Reader::SkipMarkup()
+    {
+        if (*cur == '?')
+            SkipPast("?>");
+        else if (end - cur >= 3 && !std::memcmp(cur, "!--", 3))
+            SkipPast("-->");
+        else if (end - cur >= 8 && !std::memcmp(cur, "![CDATA[", 8))
+            SkipPast("]]>");
+        else
+            SkipDoctype();
+    }
+
+    // Moves cur past the '>' of the tag it's in; returns whether the tag
+    // closes itself. Values may contain '>', so each candidate is checked for
+    // a quote before it.
+    bool Reader::SkipTag()
+    {
+        for (;;)
+        {
+            auto const gt = static_cast<char const *>(std::memchr(cur, '>', size_t(end - cur)));
+            if (!gt)
+                Throw("Unterminated tag");
+            auto quote = static_cast<char const *>(std::memchr(cur, '"', size_t(gt - cur)));
+            if (auto const apos = static_cast<char const *>(std::memchr(cur, '\'', size_t(gt - cur))))
+                quote = quote ? std::min(quote, apos) : apos;
+            if (!quote)
+            {
+                cur = gt + 1;
+                return gt[-1] == '/';
+            }
+            auto const last = static_cast<char const *>(std::memchr(quote + 1, *quote, size_t(end - quote - 1)));
+            if (!last)
+                Throw("Unterminated attribute value");
+            cur = last + 1;
+        }
+    }
+
+    static bool IsNameEnd(char c)
+    { return IsSpace(c) || c == '>' || c == '/'; }
+
+    // Moves cur from the content of the innermost open element to the '/' of
+    // its end tag. Values can't hold a raw '<', so only the character after
+    // each '<' is looked at, and only the elements of the same name are
+    // counted; skipped content isn't checked.
+    void Reader::SkipContent()
+    {
+        auto const name = open.back();
+        auto const named = [&](char const *p)
+        {
+            return size_t(end - p) > name.size() && !std::memcmp(p, name.data(), name.size()) &&
+                IsNameEnd(p[name.size()]);
+        };
+        size_t depth = 0;
+        for (;;)
+        {
+            auto const lt = static_cast<char const *>(std::memchr(cur, '<', size_t(end - cur)));
+            if (!lt || lt + 1 == end)
+            {
+                cur = end;
+                Throw("Unclosed element");
+            }
+            cur = lt + 1;
+            switch (*cur)
+            {
+            case '?':
+            case '!':
+                SkipMarkup();
+                break;
+            case '/':
+                if (named(cur + 1) && !depth--)
+                    return;
+                break;
+            default:
+                if (named(cur) && !SkipTag())
+                    depth++;
+                break;
+            }
+        }
+    }
+
+    std::string_view Reader::ReadName()
+    {
+        char const *const first = cur;
+        while (cur != end && !IsSpace(*cur) && *cur != '/' && *cur != '>' && *cur != '=')
+            cur++;
+        if (cur == first)
+            Throw("Malformed name");
+        return {first, size_t(cur - first)};
+    }
+
+    static void AppendUtf8(std::string &dst, uint32_t c)
+    {
+        if (c < 0x80)
+            dst += char(c);
+        else if (c < 0x800)
+        {
+            dst += char(0xC0 | c >> 6);
+            dst += char(0x80 | (c & 0x3F));
+        }
+        else if (c < 0x10000)
+        {
+            dst += char(0xE0 | c >> 12);
+            dst += char(0x80 | (c >> 6 & 0x3F));
+            dst += char(0x80 | (c & 0x3F));
+        }
+        else
+        {
+            dst += char(0xF0 | c >> 18);
+            dst += char(0x80 | (c >> 12 & 0x3F));
+            dst += char(0x80 | (c >> 6 & 0x3F));
+            dst += char(0x80 | (c & 0x3F));
+        }
+    }
+
+    static void DecodeValue(std::string &dst, std::string_view value)
+    {
+        static struct { std::string_view Name; char Char; } const entities[] =
+        {
+            {"lt;", '<'}, {"gt;", '>'}, {"amp;", '&'}, {"quot;", '"'}, {"apos;", '\''}
+        };
+        for (size_t i = 0; i < value.size(); i++)
+        {
+            if (value[i] != '&')
+            {
+                dst += value[i];
+                continue;
+            }
+            auto const rest = value.substr(i + 1);
+            bool decoded = false;
+            for (auto const &e : entities)
+            {
+                if (rest.substr(0, e.Name.size()) == e.Name)
+                {
+                    dst += e.Char;
+                    i += e.Name.size();
+                    decoded = true;
+                    break;
+                }
+            }
+            size_t const semicolon = rest.find(';');
+            if (!decoded && rest.size() > 1 && rest[0] == '#' && semicolon != std::string_view::npos)
+            {
+                bool const hex = rest[1] == 'x';
+                // the whole [digits, ';') range must be digits: no space, sign or base prefix
+                char const *const first = rest.data() + (hex ? 2 : 1);
+                char const *const last = rest.data() + semicolon;
+                uint32_t c = 0;
+                auto const [ptr, ec] = std::from_chars(first, last, c, hex ? 16 : 10);
+                if (ec == std::errc() && ptr == last && c < 0x110000)
+                {
+                    AppendUtf8(dst, c);
+                    i += semicolon + 1;
+                    decoded = true;
+                }
+            }
+            if (!decoded) // unknown entities are kept as is
+                dst += '&';
+        }
+    }
+
+    void Reader::DecodeValues()
+    {
+        // decoded values are never longer than raw ones: reserve once, so the
+        // views into scratch stay valid
+        size_t size = 0;
+        for (auto const &attr : element.Attributes)
+            size += attr.Value.size();
+        scratch.clear();
+        scratch.reserve(size);
+        for (auto &attr : element.Attributes)
+        {
+            if (!std::memchr(attr.Value.data(), '&', attr.Value.size()))
+                continue;
+            size_t const offset = scratch.size();
+            DecodeValue(scratch, attr.Value);
+            attr.Value = {scratch.data() + offset, scratch.size() - offset};
+        }
+    }
+
+    void Reader::ReadStartTag(Handler &handler)
+    {
+        element.Name = ReadName();
+        element.Attributes.clear();
+        bool entities = false;
+        for (;;)
+        {
+            SkipSpace();
+            if (cur == end)
+                Throw("Unexpected end of document");
+            if (*cur == '>' || *cur == '/')
+                break;
+            Attribute attr;
+            attr.Name = ReadName();
+            SkipSpace();
+            if (cur == end || *cur != '=')
+                Throw("Malformed attribute");
+            cur++;
+            SkipSpace();
+            if (cur == end || (*cur != '"' && *cur != '\''))
+                Throw("Malformed attribute");
+            char const quote = *cur++;
+            auto const last = static_cast<char const *>(std::memchr(cur, quote, size_t(end - cur)));
+            if (!last)
+                Throw("Unterminated attribute value");
+            attr.Value = {cur, size_t(last - cur)};
+            cur = last + 1;
+            entities = entities || std::memchr(attr.Value.data(), '&', attr.Value.size());
+            element.Attributes.push_back(attr);
+        }
+        if (entities)
+            DecodeValues();
+        if (*cur == '>')
+        {
+            cur++;
+            open.push_back(element.Name);
+            if (!handler.StartElement(element))
+            {
+                char const *const content = cur;
+                SkipContent();
+                handler.SkippedContent({content, size_t(cur - 1 - content)});
+                ReadEndTag(handler);
+            }
+            return;
+        }
+        if (end - cur < 2 || cur[1] != '>')
+            Throw("Malformed tag");
+        cur += 2;
+        auto const name = element.Name;
+        handler.StartElement(element);
+        handler.EndElement(name);
+    }
+
+    void Reader::ReadEndTag(Handler &handler)
+    {
+        cur++; // '/'
+        auto const name = ReadName();
+        SkipSpace();
+        if (cur == end || *cur != '>')
+            Throw("Malformed end tag");
+        cur++;
+        if (open.empty() || open.back() != name)
+            Throw("Mismatched end tag");
+        open.pop_back();
+        handler.EndElement(name);
+    }
+
+    void Reader::Parse(Handler &handler, bool document)
+    {
+        bool root = false;
+        for (;;)
+        {
+            auto const lt = static_cast<char const *>(std::memchr(cur, '<', size_t(end - cur)));
+            if (!lt)
+                break;
+            cur = lt + 1;
+            if (cur == end)
+                Throw("Unexpected end of document");
+            switch (*cur)
+            {
+            case '?':
+            case '!':
+                SkipMarkup();
+                break;
+            case '/':
+                ReadEndTag(handler);
+                break;
+            default:
+                if (document && open.empty() && root)
+                    Throw("Multiple root elements");
+                root = true;
+                ReadStartTag(handler);
+                break;
+            }
+        }
+        if (!open.empty())
+            Throw("Unclosed element");
+        if (document && !root)
+            Throw("No root element");
+    }
+
+    void Reader::Read(Handler &handler)
+    {
+        if (end - cur >= 3 && !std::memcmp(cur, "\xEF\xBB\xBF", 3))
+            cur += 3;
+        Parse(handler, true);
+    }
+
+    void Reader::ReadContent(Handler &handler)
+    { Parse(handler, false); }
+} // namespace XML
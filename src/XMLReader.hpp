@@ -0,0 +1,266 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+#pragma once
+
+#include "Common.hpp"
+#include <array>
+#include <charconv> // std::from_chars_result
+#include <iterator> // std::size
+#include <stdexcept> // std::runtime_error
+#include <string>
+#include <string_view>
+#include <type_traits> // std::remove_reference_t
+#include <vector>
+
+namespace XML
+{
+    // Malformed document or missing attribute
+    class Error : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    struct Attribute
+    {
+        std::string_view Name;
+        std::string_view Value;
+    };
+
+    // Decimal number as written, Mantissa/10^Scale. EAGLE writes coordinates
+    // with a fixed number of fractional digits, so they are kept exact until
+    // they're scaled, and only rounded once.
+    struct FixedDecimal
+    {
+        int64_t Mantissa = 0;
+        uint32_t Scale = 0; // fractional digits
+
+        // Parses [-]digits[.digits] like std::from_chars: stops at the first
+        // character that isn't part of the number, and reports out of range
+        // values instead of losing digits. Exponents aren't supported.
+        static std::from_chars_result FromChars(char const *first, char const *last, FixedDecimal &value);
+
+        double ToDouble() const;
+        // Returns the value multiplied by factor/10^factorScale
+        double Scaled(int64_t factor, uint32_t factorScale) const;
+    };
+
+    // Start tag of an element. Names and values point into the document, or into
+    // the reader for values with entities, and stay valid until the next event.
+    class Element
+    {
+    public:
+        std::string_view Name;
+        std::vector<Attribute> Attributes;
+
+        Attribute const *Find(std::string_view key) const
+        {
+            for (auto const &attr : Attributes)
+            {
+                if (attr.Name == key)
+                    return &attr;
+            }
+            return nullptr;
+        }
+
+        bool HasAttribute(std::string_view key) const
+        { return Find(key) != nullptr; }
+
+        // These throw Error if the attribute is missing or isn't a number
+        std::string_view String(std::string_view key) const;
+        int32_t Int32(std::string_view key) const;
+        double Double(std::string_view key) const;
+
+        static int32_t ToInt32(Attribute const &attr);
+        static FixedDecimal ToDecimal(Attribute const &attr);
+        static double ToDouble(Attribute const &attr);
+    };
+
+    // Attribute found by AttributeSet, or the key of a missing one
+    struct AttributeRef
+    {
+        std::string_view Key;
+        Attribute const *Attr = nullptr;
+
+        bool Has() const { return Attr != nullptr; }
+        // These throw Error if the attribute is missing or isn't a number
+        std::string_view String() const { return Get().Value; }
+        int32_t Int32() const { return Element::ToInt32(Get()); }
+        FixedDecimal Decimal() const { return Element::ToDecimal(Get()); }
+        double Double() const { return Element::ToDouble(Get()); }
+
+    private:
+        Attribute const &Get() const
+        {
+            if (!Attr)
+                throw Error("Attribute not found: " + std::string(Key));
+            return *Attr;
+        }
+    };
+
+    // Binds an attribute name to an AttributeRef member of T
+    template <typename T>
+    struct AttributeKey
+    {
+        using Object = T;
+
+        std::string_view Name;
+        AttributeRef T::*Member;
+    };
+
+    // Perfect hash of N names, built at compile time. Names are told apart by
+    // their size and first two characters packed in an integer, which is mixed
+    // by a multiplier picked so that every name gets its own slot.
+    template <size_t N>
+    class KeyTable
+    {
+    private:
+        static constexpr size_t SlotCount = 4*N;
+        static constexpr uint8_t NoKey = 0xFF;
+        static_assert(N < NoKey);
+
+        std::array<uint32_t, N> signatures{};
+        std::array<uint8_t, SlotCount> slots{};
+        uint32_t multiplier = 0;
+
+        // names are never empty
+        static constexpr uint32_t Signature(std::string_view name)
+        {
+            uint32_t const second = name.size() > 1 ? uint8_t(name[1]) : 0;
+            return uint32_t(name.size()) << 16 | uint32_t(uint8_t(name[0])) << 8 | second;
+        }
+
+        constexpr size_t Slot(uint32_t signature) const
+        { return size_t((uint64_t(signature*multiplier) * SlotCount) >> 32); }
+
+    public:
+        constexpr KeyTable(std::array<std::string_view, N> const &names)
+        {
+            for (size_t i = 0; i < N; i++)
+                signatures[i] = Signature(names[i]);
+            for (uint32_t m = 0x9E3779B1; m != 0x9E3779B1 + 2*1024; m += 2)
+            {
+                multiplier = m;
+                for (auto &slot : slots)
+                    slot = NoKey;
+                size_t i = 0;
+                for (; i < N && slots[Slot(signatures[i])] == NoKey; i++)
+                    slots[Slot(signatures[i])] = uint8_t(i);
+                if (i == N)
+                    return;
+            }
+            multiplier = 0;
+        }
+
+        // Keys must differ in size or in the first two characters
+        constexpr bool Valid() const { return multiplier != 0; }
+
+        // Returns the index of the key that may match name, or N; the rest of
+        // the name past two characters is left for the caller to compare
+        size_t Find(std::string_view name) const
+        {
+            uint32_t const signature = Signature(name);
+            uint8_t const i = slots[Slot(signature)];
+            if (i == NoKey || signatures[i] != signature)
+                return N;
+            return i;
+        }
+    };
+
+    // Looks up a fixed set of attributes in one walk over an element, with
+    // a single probe per attribute, and fills a struct with them:
+    //   struct Attrs { XML::AttributeRef X, Y; };
+    //   static constexpr XML::AttributeKey<Attrs> keys[] = {{"x", &Attrs::X}, {"y", &Attrs::Y}};
+    //   auto const attrs = XML::AttributeSet<keys>::Read(element);
+    //   double const x = attrs.X.Double();
+    template <auto const &Keys>
+    class AttributeSet
+    {
+    private:
+        using Object = typename std::remove_reference_t<decltype(Keys[0])>::Object;
+        static constexpr size_t N = std::size(Keys);
+        static constexpr KeyTable<N> table = []()
+        {
+            std::array<std::string_view, N> names{};
+            for (size_t i = 0; i < N; i++)
+                names[i] = Keys[i].Name;
+            return KeyTable<N>(names);
+        }();
+        static_assert(table.Valid(), "Keys must differ in size or in the first two characters");
+
+    public:
+        static Object Read(Element const &element)
+        {
+            Object obj{};
+            for (auto const &key : Keys)
+                (obj.*key.Member).Key = key.Name;
+            for (auto const &attr : element.Attributes)
+            {
+                auto const &name = attr.Name;
+                size_t const i = table.Find(name);
+                if (i == N || (name.size() > 2 && name.compare(2, name.npos, Keys[i].Name.substr(2))))
+                    continue;
+                auto &ref = obj.*Keys[i].Member;
+                // the first one wins, as with Element::Find
+                if (!ref.Attr)
+                    ref.Attr = &attr;
+            }
+            return obj;
+        }
+    };
+
+    // Receives elements in document order; text, comments, processing
+    // instructions and the doctype are dropped
+    class Handler
+    {
+    public:
+        virtual ~Handler() = default;
+        // Returns whether to report the content of the element; skipped
+        // content is only scanned for the matching end tag
+        virtual bool StartElement(Element const &element) = 0;
+        // Gets the content of a skipped element, before its EndElement
+        virtual void SkippedContent(std::string_view) {}
+        virtual void EndElement(std::string_view name) = 0;
+    };
+
+    // Event-driven reader: walks a document in memory once, reporting elements
+    // as it meets them instead of building a tree, so memory use depends on
+    // what the handler keeps rather than on the document size.
+    class Reader
+    {
+    private:
+        char const *origin;
+        char const *cur;
+        char const *end;
+        Element element;
+        // decoded values of the current element
+        std::string scratch;
+        // names of the elements that are open at cur
+        std::vector<std::string_view> open;
+
+        [[noreturn]] void Throw(char const *what) const;
+        void SkipSpace();
+        void SkipPast(std::string_view terminator);
+        void SkipDoctype();
+        void SkipMarkup();
+        bool SkipTag();
+        void SkipContent();
+        std::string_view ReadName();
+        void DecodeValues();
+        void ReadStartTag(Handler &handler);
+        void ReadEndTag(Handler &handler);
+        void Parse(Handler &handler, bool document);
+
+    public:
+        Reader(char const *data, size_t size);
+        // Reads a part of a document, e.g. the content of a skipped element;
+        // errors are reported with line numbers from origin
+        Reader(char const *data, size_t size, char const *origin);
+
+        // Reads the whole document; throws Error if it's malformed
+        void Read(Handler &handler);
+        // Reads a sequence of elements, as found in the content of an element
+        void ReadContent(Handler &handler);
+    };
+} // namespace XML
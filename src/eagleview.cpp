@@ -2,7 +2,12 @@
 // Copyright (c) 2019 Pavel Kovalenko
 
 #include <cstdio> // std::puts
+#include <cstring> // std::strncmp, std::strchr, std::strlen
+#include <exception> // std::exception
 #include <fstream> // std::ofstream
+#include <string>
+#include <utility> // std::pair, std::move
+#include <vector>
 #include "BoardFormat.hpp"
 #include "BoardFormatRegistrator.hpp"
 #include "CBF/Board.hpp"
@@ -10,7 +15,7 @@
 static void PrintUsage()
 {
     puts("usage:\n"
-        "    eagleview <input format> <input path> <output format> <output path>\n"
+        "    eagleview [--<option>=<value>...] <input format> <input path> <output format> <output path>\n"
         "\nsupported formats:");
     using RegNode = BoardFormatRegistrator::Node;
     for (RegNode const *n = RegNode::First; n; n = n->Next)
@@ -24,22 +29,45 @@ static void PrintUsage()
         if (caps.empty())
             caps += "-";
         printf("    -%s [%s] %s\n", frep.Tag(), caps.data(), frep.Desc());
+        for (char const *opt = frep.Options(); *opt;)
+        {
+            char const *eol = std::strchr(opt, '\n');
+            if (!eol)
+                eol = opt + std::strlen(opt);
+            printf("        --%.*s\n", int(eol - opt), opt);
+            opt = *eol ? eol + 1 : eol;
+        }
     }
 }
 
 int main(int argc, char const *argv[])
 {
     BoardFormatRegistrator::Register();
-    if (argc != 5)
+    std::vector<std::pair<std::string, std::string>> options;
+    std::vector<char const *> args;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--", 2))
+        {
+            args.push_back(argv[i]);
+            continue;
+        }
+        std::string const opt = argv[i] + 2;
+        auto const sep = opt.find('=');
+        if (sep == std::string::npos)
+            options.emplace_back(opt, "");
+        else
+            options.emplace_back(opt.substr(0, sep), opt.substr(sep + 1));
+    }
+    if (args.size() != 4)
     {
         PrintUsage();
         return 1;
     }
-    char const *srcFormat = argv[1],
-        *srcPath = argv[2],
-        *dstFormat = argv[3],
-        *dstPath = argv[4];
-    // XXX: catch exceptions
+    char const *srcFormat = args[0],
+        *srcPath = args[1],
+        *dstFormat = args[2],
+        *dstPath = args[3];
     auto src = BoardFormat::Create(srcFormat+1);
     if (!src)
     {
@@ -62,26 +90,43 @@ int main(int argc, char const *argv[])
         puts("! The output format is not writeable");
         return 1;
     }
-    CBF::Board brd;
+    for (auto const &[name, value] : options)
     {
-        auto fs = std::ifstream(srcPath, std::ios::binary);
-        if (!fs)
+        bool const srcOpt = src->SetOption(name.c_str(), value.c_str());
+        bool const dstOpt = dst->SetOption(name.c_str(), value.c_str());
+        if (!srcOpt && !dstOpt)
         {
-            printf("! Can't read '%s'\n", srcPath);
+            printf("! Unrecognized option '--%s=%s'\n", name.c_str(), value.c_str());
             return 1;
         }
-        src->Read(fs);
-        src->Export(brd);
     }
+    try
     {
-        auto fs = std::ofstream(dstPath, std::ios::binary);
-        if (!fs)
+        std::ofstream fs;
         {
-            printf("! Can't write '%s'\n", dstPath);
-            return 1;
+            // keep at most two copies of the board alive at any time
+            CBF::Board brd;
+            if (!src->ReadFile(srcPath))
+            {
+                printf("! Can't read '%s'\n", srcPath);
+                return 1;
+            }
+            std::move(*src).Export(brd);
+            src.reset();
+            fs.open(dstPath, std::ios::binary);
+            if (!fs)
+            {
+                printf("! Can't write '%s'\n", dstPath);
+                return 1;
+            }
+            dst->Import(brd);
         }
-        dst->Import(brd);
         dst->Write(fs);
     }
+    catch (std::exception const &e)
+    {
+        printf("! %s\n", e.what());
+        return 1;
+    }
     return 0;
 }
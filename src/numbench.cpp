@@ -0,0 +1,137 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+// Compares number parsing for EAGLE coordinates: std::strtod scaled to mils,
+// as the reader used before, against XML::FixedDecimal, which keeps the
+// digits exact and rounds once when scaling. Values look like EAGLE
+// coordinates and angles, i.e. decimals with up to four fractional digits.
+
+#include <chrono> // std::chrono::steady_clock
+#include <cstdio> // std::puts, std::snprintf
+#include <cstdlib> // std::abs, std::strtod, std::strtoul
+#include <cstring> // std::strncmp, std::strlen
+#include <random> // std::mt19937
+#include <string>
+#include <vector>
+#include "XMLReader.hpp"
+
+namespace
+{
+    struct Params
+    {
+        uint32_t Values = 4096;
+        uint32_t Rounds = 1000;
+        uint32_t Seed = 1;
+    };
+
+    std::vector<std::string> MakeValues(Params const &params)
+    {
+        // std::mt19937 output is fully specified, distributions aren't
+        std::mt19937 rng(params.Seed);
+        std::vector<std::string> values;
+        values.reserve(params.Values);
+        for (uint32_t i = 0; i < params.Values; i++)
+        {
+            int const whole = int(rng() % 400) - 200;
+            uint32_t const digits = 1 + rng() % 4;
+            uint32_t scale = 1;
+            for (uint32_t d = 0; d < digits; d++)
+                scale *= 10;
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%s%d.%0*u", whole < 0 ? "-" : "", std::abs(whole),
+                int(digits), uint32_t(rng() % scale));
+            values.push_back(buf);
+        }
+        return values;
+    }
+
+    template <typename F>
+    double Measure(Params const &params, std::vector<std::string> const &values, double &sum, F &&parse)
+    {
+        using Clock = std::chrono::steady_clock;
+        auto const start = Clock::now();
+        for (uint32_t r = 0; r < params.Rounds; r++)
+        {
+            for (auto const &value : values)
+                sum += parse(value);
+        }
+        std::chrono::duration<double, std::nano> const time = Clock::now() - start;
+        return time.count() / (double(params.Rounds) * values.size());
+    }
+
+    void PrintUsage()
+    {
+        puts("usage:\n"
+            "    numbench [--<option>=<value>...]\n"
+            "\noptions:\n"
+            "    --values=N  distinct values (default: 4096)\n"
+            "    --rounds=N  passes over the values (default: 1000)\n"
+            "    --seed=N  random seed (default: 1)");
+    }
+
+    bool ParseOption(Params &params, char const *arg)
+    {
+        struct { char const *Name; uint32_t *Value; } const options[] =
+        {
+            {"--values=", &params.Values},
+            {"--rounds=", &params.Rounds},
+            {"--seed=", &params.Seed},
+        };
+        for (auto const &opt : options)
+        {
+            size_t const len = std::strlen(opt.Name);
+            if (std::strncmp(arg, opt.Name, len))
+                continue;
+            char *end;
+            *opt.Value = uint32_t(std::strtoul(arg + len, &end, 10));
+            return arg[len] && !*end;
+        }
+        return false;
+    }
+} // namespace
+
+int main(int argc, char const *argv[])
+{
+    Params params;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!ParseOption(params, argv[i]))
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (!params.Values || !params.Rounds)
+    {
+        PrintUsage();
+        return 1;
+    }
+    auto const values = MakeValues(params);
+    auto const strtodMils = [](std::string const &value)
+        { return 39.3701*std::strtod(value.c_str(), nullptr); };
+    auto const decimalMils = [](std::string const &value)
+        { return XML::Element::ToDecimal({"x", value}).Scaled(393701, 4); };
+    double strtodSum = 0, decimalSum = 0;
+    double const strtodTime = Measure(params, values, strtodSum, strtodMils);
+    double const decimalTime = Measure(params, values, decimalSum, decimalMils);
+    printf("- strtod: %.1f ns per value\n", strtodTime);
+    printf("- fixed decimal: %.1f ns per value\n", decimalTime);
+    // both round correctly, so unscaled values must be the same
+    uint32_t mismatches = 0, drifts = 0;
+    for (auto const &value : values)
+    {
+        if (std::strtod(value.c_str(), nullptr) != XML::Element::ToDouble({"x", value}))
+            mismatches++;
+        if (strtodMils(value) != decimalMils(value))
+            drifts++;
+    }
+    if (mismatches)
+    {
+        printf("! %u values parsed differently\n", mismatches);
+        return 1;
+    }
+    puts("- results match");
+    // strtod rounds twice, before and after scaling
+    printf("- %u values scaled to mils differently\n", drifts);
+    return 0;
+}
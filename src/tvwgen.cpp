@@ -0,0 +1,474 @@
+// MIT License
+// Copyright (c) 2020 Pavel Kovalenko
+
+// Generates synthetic TVW boards of a given size for load benchmarks. The
+// output only depends on the options, so a corpus can be recreated anywhere.
+
+#include <algorithm> // std::min
+#include <cmath> // std::cos, std::sin
+#include <cstdio> // std::puts
+#include <cstdlib> // std::strtoul
+#include <cstring> // std::strncmp, std::strcmp
+#include <exception> // std::exception
+#include <fstream>
+#include <iterator> // std::istreambuf_iterator
+#include <random> // std::mt19937
+#include <sstream> // std::ostringstream
+#include <string>
+#include "StringPool.hpp"
+#include "TeboBoard.hpp"
+
+namespace
+{
+    struct Params
+    {
+        uint32_t Layers = 4; // copper layers, route and drill layers are added
+        uint32_t Parts = 1000;
+        uint32_t Pins = 8; // per part
+        uint32_t Vertices = 100000; // surface vertices per copper layer
+        uint32_t Seed = 1;
+        bool Verify = false;
+    };
+
+    // Coordinates are in 0.01 mil
+    int32_t const BoardSize = 1000000;
+    uint32_t const SurfaceSize = 1024; // vertices per surface, cutout included
+    uint32_t const CutoutSize = 4;
+    uint32_t const NetCount = 512;
+
+    class Generator
+    {
+    private:
+        Params const &params;
+        // std::mt19937 output is fully specified, distributions aren't
+        std::mt19937 rng;
+        StringPool strings;
+
+        int32_t Random(int32_t min, int32_t max)
+        { return min + int32_t(rng() % uint32_t(max - min + 1)); }
+
+        Tebo::Vector2S RandomPos()
+        { return {Random(0, BoardSize), Random(0, BoardSize)}; }
+
+        std::string_view String(std::string const &s)
+        { return strings.Store(s.data(), s.size()); }
+
+        int32_t RandomNet()
+        { return Random(0, NetCount - 1); }
+
+        void InitObject(Tebo::Object &obj, std::string const &name, Tebo::LayerType type)
+        {
+            obj.Magic[0] = 2;
+            obj.Magic[1] = 1;
+            obj.Name = String(name);
+            obj.InitialName = obj.Name;
+            obj.InitialPath = String(name + ".gbr");
+            obj.Type = type;
+            obj.PadColor = 0x00ff00;
+            obj.LineColor = 0x0000ff;
+        }
+
+        void AddShapes(Tebo::LogicLayer &layer)
+        {
+            auto &round = layer.Shapes.emplace_back();
+            round.Type = Tebo::ShapeType::Round;
+            round.Size = {800, 800};
+            auto &trace = layer.Shapes.emplace_back();
+            trace.Type = Tebo::ShapeType::Round;
+            trace.Size = {500, 500};
+            auto &rect = layer.Shapes.emplace_back();
+            rect.Type = Tebo::ShapeType::Rect;
+            rect.Size = {1500, 600};
+            auto &roundRect = layer.Shapes.emplace_back();
+            roundRect.Type = Tebo::ShapeType::RoundRect;
+            roundRect.Size = {2000, 1000};
+            roundRect.CornerRadius = 200;
+            auto &poly = layer.Shapes.emplace_back();
+            poly.Type = Tebo::ShapeType::Poly;
+            poly.Size = {1200, 1200};
+            poly.Name = String("poly");
+            poly.BBox = {{-600, -600}, {600, 600}};
+            poly.VertexListIndex = 0;
+            poly.FirstVertex = uint32_t(layer.ShapeData.Vertices.size());
+            poly.VertexCount = 4;
+            layer.ShapeData.Vertices.insert(layer.ShapeData.Vertices.end(),
+                {{-600, -600}, {600, -600}, {600, 600}, {-600, 600}});
+            poly.FirstLine = uint32_t(layer.ShapeData.Lines.size());
+            poly.LineCount = 1;
+            auto &line = layer.ShapeData.Lines.emplace_back();
+            line.Param1 = 1;
+            line.Start = {-600, 0};
+            line.End = {600, 0};
+            line.Width = 100;
+        }
+
+        void AddPad(Tebo::LogicLayer &layer, Tebo::Vector2S pos, int32_t net)
+        {
+            uint32_t const index = uint32_t(layer.Pads.size());
+            auto &pad = layer.Pads.emplace_back();
+            pad.Shape = index % 5 == 4 ? 3 : index % 3 == 2 ? 2 : 0;
+            pad.DCode = pad.Shape + 10;
+            pad.Net = net;
+            pad.Pos = pos;
+            pad.IsCopper = true;
+            pad.IsExposed = index % 4 == 0;
+            pad.TestpointParam = index % 16 == 0 ? 1 : 0;
+            pad.HasHole = index % 32 == 0;
+            if (pad.TestpointParam == 1)
+                layer.PadTestPoints.Add(index);
+            if (pad.IsExposed)
+            {
+                int32_t const x = pos.X.ToRawInt(), y = pos.Y.ToRawInt();
+                auto &exposed = layer.PadExposedAreas.Add(index);
+                exposed.Min = {x - 400, y - 400};
+                exposed.Max = {x + 400, y + 400};
+            }
+            if (pad.HasHole)
+                layer.PadHoles.Add(index).Size = {300, 300};
+        }
+
+        void AddSurfaces(Tebo::LogicLayer &layer)
+        {
+            for (uint32_t left = params.Vertices; left >= 2*CutoutSize;)
+            {
+                uint32_t const size = std::min(left, SurfaceSize);
+                left -= size;
+                auto &surface = layer.Surfaces.emplace_back();
+                surface.Net = RandomNet();
+                surface.LineWidth = 100;
+                // outline: a circle-ish polygon, cutout: a square in its middle
+                auto const center = RandomPos();
+                int32_t const radius = Random(5000, 50000);
+                uint32_t const outlineSize = size - CutoutSize;
+                surface.Vertices.reserve(outlineSize);
+                for (uint32_t i = 0; i < outlineSize; i++)
+                {
+                    double const a = 6.283185307179586*i/outlineSize;
+                    surface.Vertices.push_back({center.X.ToRawInt() + int32_t(radius*std::cos(a)),
+                        center.Y.ToRawInt() + int32_t(radius*std::sin(a))});
+                }
+                surface.EdgeCount = outlineSize;
+                auto &cutout = surface.Voids.emplace_back();
+                int32_t const half = radius/4;
+                int32_t const x = center.X.ToRawInt(), y = center.Y.ToRawInt();
+                cutout.Vertices = {{x - half, y - half}, {x + half, y - half},
+                    {x + half, y + half}, {x - half, y + half}};
+                cutout.EdgeCount = CutoutSize;
+                surface.VoidCount = 1;
+            }
+        }
+
+        std::unique_ptr<Tebo::LogicLayer> MakeLogicLayer(uint32_t index)
+        {
+            Tebo::LayerType type;
+            switch (index)
+            {
+            case 0: type = Tebo::LayerType::Top; break;
+            case 1: type = Tebo::LayerType::Bottom; break;
+            default: type = index % 2 ? Tebo::LayerType::Plane : Tebo::LayerType::Signal; break;
+            }
+            auto layer = std::make_unique<Tebo::LogicLayer>();
+            InitObject(*layer, "layer" + std::to_string(index), type);
+            AddShapes(*layer);
+            // parts alternate between the top and the bottom layer
+            if (index < 2)
+            {
+                for (uint32_t pi = index; pi < params.Parts; pi += 2)
+                {
+                    auto const pos = RandomPos();
+                    for (uint32_t i = 0; i < params.Pins; i++)
+                    {
+                        Tebo::Vector2S const pinPos = {pos.X.ToRawInt() + int32_t(i)*2000, pos.Y};
+                        AddPad(*layer, pinPos, RandomNet());
+                    }
+                }
+            }
+            // one trace per pad, a few arcs
+            for (auto const &pad : layer->Pads)
+            {
+                auto &line = layer->Lines.emplace_back();
+                line.Net = pad.Net;
+                line.DCode = 11;
+                line.StartPos = pad.Pos;
+                line.EndPos = RandomPos();
+            }
+            for (size_t i = 0; i < layer->Pads.size()/8; i++)
+            {
+                auto &arc = layer->Arcs.emplace_back();
+                arc.Net = RandomNet();
+                arc.DCode = 11;
+                arc.Pos = RandomPos();
+                arc.Radius = Random(1000, 10000);
+                arc.StartAngle = 0;
+                arc.SweepAngle = 90;
+            }
+            AddSurfaces(*layer);
+            layer->UnknownItemCount = 0;
+            layer->UnknownItemsParam = 0;
+            layer->TpCount = 0;
+            layer->TPS2Size = 0;
+            layer->TPS2Param = 0;
+            layer->TPS3Size = 0;
+            layer->TPS3Param = 0;
+            layer->TestSequenceSize = 0;
+            layer->TestSequenceParam = 0;
+            return layer;
+        }
+
+        // board outline
+        std::unique_ptr<Tebo::ThroughLayer> MakeRouteLayer()
+        {
+            auto layer = std::make_unique<Tebo::ThroughLayer>();
+            InitObject(*layer, "route", Tebo::LayerType::Roul);
+            auto &tool = layer->Tools.emplace_back();
+            tool.Flag1 = true;
+            tool.Flag2 = false;
+            tool.Size = 500;
+            Tebo::Vector2S const corners[] =
+                {{0, 0}, {BoardSize, 0}, {BoardSize, BoardSize}, {0, BoardSize}};
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                layer->DrillSlots.push_back({-1, 1, corners[i], corners[(i + 1) % 4], 0});
+                layer->DrillCodes.push_back(0x0A);
+            }
+            return layer;
+        }
+
+        std::unique_ptr<Tebo::ThroughLayer> MakeDrillLayer(Tebo::Board const &board)
+        {
+            auto layer = std::make_unique<Tebo::ThroughLayer>();
+            InitObject(*layer, "drill", Tebo::LayerType::Drill);
+            auto &tool = layer->Tools.emplace_back();
+            tool.Flag1 = true;
+            tool.Flag2 = false;
+            tool.Size = 300;
+            for (auto const &obj : board.Layers)
+            {
+                auto const logic = dynamic_cast<Tebo::LogicLayer const *>(obj.get());
+                if (!logic)
+                    continue;
+                for (size_t i = 0; i < logic->PadHoles.Size(); i++)
+                {
+                    auto const &pad = logic->Pads[logic->PadHoles.Pads[i]];
+                    layer->DrillHoles.push_back({pad.Net, 1, pad.Pos});
+                    layer->DrillCodes.push_back(0x08);
+                }
+            }
+            return layer;
+        }
+
+        void AddParts(Tebo::Board &board)
+        {
+            board.Parts.reserve(params.Parts);
+            // pads of the parts on each side, in the order they were added
+            uint32_t sidePad[2] = {};
+            for (uint32_t pi = 0; pi < params.Parts; pi++)
+            {
+                uint32_t const side = pi % 2;
+                auto const &layer = static_cast<Tebo::LogicLayer const &>(*board.Layers[1 + side]);
+                auto &part = board.Parts.emplace_back();
+                part.Name = String("U" + std::to_string(pi + 1));
+                part.Pos = layer.Pads[sidePad[side]].Pos;
+                part.Bbox = {part.Pos, {part.Pos.X.ToRawInt() + int32_t(params.Pins)*2000, part.Pos.Y}};
+                part.Angle = 0;
+                part.Decal = pi % uint32_t(board.Decals.size());
+                part.Type = Tebo::PartType::Chip;
+                part.Z1 = 0;
+                part.Height = 5000;
+                part.Flag0 = false;
+                part.Value = String("10k");
+                part.ToleranceP = String("5%");
+                part.ToleranceN = String("5%");
+                part.Desc = String("PN-" + std::to_string(pi % 97));
+                part.PinCount = params.Pins;
+                part.Layer = 1 + side; // after the route layer
+                part.P2 = 0;
+                part.Pins.reserve(params.Pins);
+                for (uint32_t i = 0; i < params.Pins; i++)
+                {
+                    auto &pin = part.Pins.emplace_back();
+                    pin.Handle = (sidePad[side]++)*8;
+                    pin.Z1 = 0;
+                    pin.Id = i + 1;
+                    pin.Name = String(std::to_string(i + 1));
+                    pin.Z2 = 0;
+                }
+            }
+        }
+
+        void AddDecals(Tebo::Board &board)
+        {
+            for (uint32_t i = 0; i < 16; i++)
+            {
+                auto &decal = board.Decals.emplace_back();
+                decal.Flag1 = true;
+                decal.Name = String("DECAL" + std::to_string(i));
+                decal.HeaderParams[0] = decal.HeaderParams[1] = decal.HeaderParams[2] = 0;
+                decal.Flag = false;
+                decal.OutlineFlag = true;
+                decal.Param = 2;
+                decal.N1 = -1;
+                decal.Outline = {{0, 0}, {2000, 0}, {2000, 1000}, {0, 1000}};
+                decal.OutlineVertexCount = uint32_t(decal.Outline.size());
+                decal.Params[0] = decal.Params[1] = 0;
+            }
+        }
+
+        void AddRegistries(Tebo::Board &board)
+        {
+            auto &probes = board.Probes;
+            probes.Z1 = probes.Z2 = 0;
+            probes.Param = 4;
+            probes.Name = String("default");
+            probes.DefaultSize = 11811;
+            probes.Packs.resize(1);
+            auto &fixtures = board.Fixtures;
+            fixtures.Tag1 = 0;
+            fixtures.Tag2 = 7874;
+            fixtures.Grids.assign(8, String("100"));
+            for (auto setting : {&fixtures.Top, &fixtures.Bottom})
+            {
+                setting->Tag = 3;
+                setting->Name = String(setting == &fixtures.Top ? "top" : "bottom");
+                setting->Param = 0;
+                setting->WorkspaceSize = {BoardSize, BoardSize};
+            }
+            board.Myb = {};
+            board.Myb.TopRight = {BoardSize, BoardSize};
+        }
+
+    public:
+        Generator(Params const &p) :
+            params(p),
+            rng(p.Seed)
+        {}
+
+        void Generate(Tebo::Board &board)
+        {
+            auto &header = board.Header;
+            header.Type = String("TVW");
+            header.Const1 = 1;
+            header.Customer = String("tvwgen");
+            header.Const2 = 0;
+            header.Date = String("2020");
+            header.Const3[0] = header.Const3[1] = header.Const3[2] = 0;
+            header.Size1 = header.Size2 = header.Size3 = 0;
+            header.LayerCount = params.Layers + 2;
+            board.Layers.push_back(MakeRouteLayer());
+            for (uint32_t i = 0; i < params.Layers; i++)
+                board.Layers.push_back(MakeLogicLayer(i));
+            board.Layers.push_back(MakeDrillLayer(board));
+            for (uint32_t i = 0; i < NetCount; i++)
+                board.Nets.push_back(String("NET" + std::to_string(i)));
+            AddRegistries(board);
+            AddDecals(board);
+            AddParts(board);
+        }
+    };
+
+    void PrintUsage()
+    {
+        puts("usage:\n"
+            "    tvwgen [--<option>=<value>...] <output path>\n"
+            "\noptions:\n"
+            "    --layers=N  copper layers, route and drill layers are added (default: 4, at least 2)\n"
+            "    --parts=N  parts, placed on the top and bottom layers (default: 1000)\n"
+            "    --pins=N  pins per part (default: 8)\n"
+            "    --vertices=N  surface vertices per copper layer (default: 100000)\n"
+            "    --seed=N  random seed (default: 1)\n"
+            "    --verify  read the board back and check it's written byte for byte");
+    }
+
+    bool ParseOption(Params &params, char const *arg)
+    {
+        if (!std::strcmp(arg, "--verify"))
+        {
+            params.Verify = true;
+            return true;
+        }
+        struct { char const *Name; uint32_t *Value; } const options[] =
+        {
+            {"--layers=", &params.Layers},
+            {"--parts=", &params.Parts},
+            {"--pins=", &params.Pins},
+            {"--vertices=", &params.Vertices},
+            {"--seed=", &params.Seed},
+        };
+        for (auto const &opt : options)
+        {
+            size_t const len = std::strlen(opt.Name);
+            if (std::strncmp(arg, opt.Name, len))
+                continue;
+            char *end;
+            *opt.Value = uint32_t(std::strtoul(arg + len, &end, 10));
+            return arg[len] && !*end;
+        }
+        return false;
+    }
+} // namespace
+
+int main(int argc, char const *argv[])
+{
+    Params params;
+    char const *path = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--", 2))
+        {
+            path = argv[i];
+            continue;
+        }
+        if (!ParseOption(params, argv[i]))
+        {
+            printf("! Unrecognized option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+    if (!path || params.Layers < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+    try
+    {
+        {
+            Generator gen(params);
+            Tebo::Board board;
+            gen.Generate(board);
+            std::ofstream fs(path, std::ios::binary);
+            if (!fs)
+            {
+                printf("! Can't write '%s'\n", path);
+                return 1;
+            }
+            board.Write(fs);
+            printf("- %zu bytes written\n", size_t(fs.tellp()));
+        }
+        if (params.Verify)
+        {
+            Tebo::Board board;
+            board.SetOption("skim", "off");
+            if (!board.ReadFile(path))
+            {
+                printf("! Can't read '%s'\n", path);
+                return 1;
+            }
+            std::ostringstream os;
+            board.Write(os);
+            std::ifstream fs(path, std::ios::binary);
+            std::string const data((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+            if (os.str() != data)
+            {
+                puts("! Round trip mismatch");
+                return 1;
+            }
+            puts("- round trip ok");
+        }
+    }
+    catch (std::exception const &e)
+    {
+        printf("! %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}